@@ -0,0 +1,686 @@
+/*
+ * blit.c
+ * This file is part of Arena1
+ *
+ * Copyright (C) 2013
+ *
+ * Arena1 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Arena1 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Arena1. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+/**
+ *  @addtogroup blit
+ *  @{
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SDL/SDL.h>
+#include "core/core.h"
+#include "blit.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BLIT_X86					/**< the SSE2 and AVX2 kernels are compiled */
+#include <immintrin.h>
+#endif
+
+
+/**
+ *  A set of kernels. Every kernel processes a rectangle, row by row.
+ */
+typedef struct {
+	void (*fill)(Uint32 *dst, int dst_pitch, int w, int h, Uint32 color);
+	void (*colorkey)(Uint32 *dst, int dst_pitch, const Uint32 *src, int src_pitch, int w, int h, Uint32 key, Uint32 mask);
+	void (*blend)(Uint32 *dst, int dst_pitch, const Uint32 *src, int src_pitch, int w, int h, Uint32 key, Uint32 mask, Uint8 alpha, bool keyed);
+} BlitKernels;
+
+static BlitKernel		 kernel = BLIT_SCALAR;			/**< the set of kernels in use */
+static BlitKernels		 a_kernels[BLIT_KERNELS];		/**< all sets of kernels, the functions are NULL if a set isn't compiled */
+static bool				 a_supported[BLIT_KERNELS];		/**< whether the processor supports a set of kernels */
+
+static char				*a_names[BLIT_KERNELS] = { "scalar", "sse2", "avx2" };
+
+#define BLIT_NEXT_ROW(ptr, pitch)		((void *)((Uint8 *)(ptr) + (pitch)))		/**< moves a pointer to the next row */
+
+// --- Scalar Kernels ---------------------------------------------------------------------------------------------------------------------
+
+/**
+ *  Blends a pixel onto another one. The red and blue channels as well as the green and
+ *  the fourth channel are blended together, the products can't overflow into each other.
+ */
+static inline Uint32 _blit_blend_pixel(Uint32 s, Uint32 d, Uint32 alpha)
+{
+	Uint32 inv = 256 - alpha;
+	Uint32 rb = (((s & 0x00FF00FF) * alpha + (d & 0x00FF00FF) * inv) >> 8) & 0x00FF00FF;
+	Uint32 ga = (((s >> 8) & 0x00FF00FF) * alpha + ((d >> 8) & 0x00FF00FF) * inv) & 0xFF00FF00;
+
+	return rb | ga;
+}
+
+/**
+ *  Fills a part of a row, used by all kernels for the pixels which are left over.
+ */
+static inline void _blit_fill_row(Uint32 *dst, int w, Uint32 color)
+{
+	int x;
+
+	for (x = 0; x < w; x++)
+		dst[x] = color;
+}
+
+/**
+ *  Copies a part of a row with a color key, used by all kernels for the pixels which are left over.
+ */
+static inline void _blit_colorkey_row(Uint32 *dst, const Uint32 *src, int w, Uint32 key, Uint32 mask)
+{
+	int x;
+
+	for (x = 0; x < w; x++) {
+		if ((src[x] & mask) != key)
+			dst[x] = src[x];
+	}
+}
+
+/**
+ *  Blends a part of a row, used by all kernels for the pixels which are left over.
+ */
+static inline void _blit_blend_row(Uint32 *dst, const Uint32 *src, int w, Uint32 key, Uint32 mask, Uint8 alpha, bool keyed)
+{
+	int x;
+
+	for (x = 0; x < w; x++) {
+		if (!keyed || (src[x] & mask) != key)
+			dst[x] = _blit_blend_pixel(src[x], dst[x], alpha);
+	}
+}
+
+static void _blit_fill_scalar(Uint32 *dst, int dst_pitch, int w, int h, Uint32 color)
+{
+	int y;
+
+	for (y = 0; y < h; y++) {
+		_blit_fill_row(dst, w, color);
+		dst = BLIT_NEXT_ROW(dst, dst_pitch);
+	}
+}
+
+static void _blit_colorkey_scalar(Uint32 *dst, int dst_pitch, const Uint32 *src, int src_pitch, int w, int h, Uint32 key, Uint32 mask)
+{
+	int y;
+
+	for (y = 0; y < h; y++) {
+		_blit_colorkey_row(dst, src, w, key, mask);
+		dst = BLIT_NEXT_ROW(dst, dst_pitch);
+		src = BLIT_NEXT_ROW(src, src_pitch);
+	}
+}
+
+static void _blit_blend_scalar(Uint32 *dst, int dst_pitch, const Uint32 *src, int src_pitch, int w, int h, Uint32 key, Uint32 mask, Uint8 alpha, bool keyed)
+{
+	int y;
+
+	for (y = 0; y < h; y++) {
+		_blit_blend_row(dst, src, w, key, mask, alpha, keyed);
+		dst = BLIT_NEXT_ROW(dst, dst_pitch);
+		src = BLIT_NEXT_ROW(src, src_pitch);
+	}
+}
+
+#ifdef BLIT_X86
+
+// --- SSE2 Kernels -----------------------------------------------------------------------------------------------------------------------
+
+__attribute__((target("sse2")))
+static void _blit_fill_sse2(Uint32 *dst, int dst_pitch, int w, int h, Uint32 color)
+{
+	__m128i c = _mm_set1_epi32((int)color);
+	int x, y;
+
+	for (y = 0; y < h; y++) {
+		for (x = 0; x + 4 <= w; x += 4)
+			_mm_storeu_si128((__m128i *)(dst + x), c);
+		_blit_fill_row(dst + x, w - x, color);
+		dst = BLIT_NEXT_ROW(dst, dst_pitch);
+	}
+}
+
+__attribute__((target("sse2")))
+static void _blit_colorkey_sse2(Uint32 *dst, int dst_pitch, const Uint32 *src, int src_pitch, int w, int h, Uint32 key, Uint32 mask)
+{
+	__m128i k = _mm_set1_epi32((int)key);
+	__m128i m = _mm_set1_epi32((int)mask);
+	__m128i s, d, transparent;
+	int x, y;
+
+	for (y = 0; y < h; y++) {
+		for (x = 0; x + 4 <= w; x += 4) {
+			s = _mm_loadu_si128((const __m128i *)(src + x));
+			d = _mm_loadu_si128((const __m128i *)(dst + x));
+			transparent = _mm_cmpeq_epi32(_mm_and_si128(s, m), k);
+			_mm_storeu_si128((__m128i *)(dst + x), _mm_or_si128(_mm_and_si128(transparent, d), _mm_andnot_si128(transparent, s)));
+		}
+		_blit_colorkey_row(dst + x, src + x, w - x, key, mask);
+		dst = BLIT_NEXT_ROW(dst, dst_pitch);
+		src = BLIT_NEXT_ROW(src, src_pitch);
+	}
+}
+
+__attribute__((target("sse2")))
+static void _blit_blend_sse2(Uint32 *dst, int dst_pitch, const Uint32 *src, int src_pitch, int w, int h, Uint32 key, Uint32 mask, Uint8 alpha, bool keyed)
+{
+	__m128i zero = _mm_setzero_si128();
+	__m128i a = _mm_set1_epi16(alpha);
+	__m128i inv = _mm_set1_epi16(256 - alpha);
+	__m128i k = _mm_set1_epi32((int)key);
+	__m128i m = _mm_set1_epi32((int)mask);
+	__m128i s, d, lo, hi, r, transparent;
+	int x, y;
+
+	for (y = 0; y < h; y++) {
+		for (x = 0; x + 4 <= w; x += 4) {
+			s = _mm_loadu_si128((const __m128i *)(src + x));
+			d = _mm_loadu_si128((const __m128i *)(dst + x));
+
+			// The channels are widened to 16 bits, (s * alpha + d * (256 - alpha)) fits into them
+			lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(s, zero), a), _mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), inv));
+			hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(s, zero), a), _mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), inv));
+			r = _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8));
+
+			if (keyed) {
+				transparent = _mm_cmpeq_epi32(_mm_and_si128(s, m), k);
+				r = _mm_or_si128(_mm_and_si128(transparent, d), _mm_andnot_si128(transparent, r));
+			}
+			_mm_storeu_si128((__m128i *)(dst + x), r);
+		}
+		_blit_blend_row(dst + x, src + x, w - x, key, mask, alpha, keyed);
+		dst = BLIT_NEXT_ROW(dst, dst_pitch);
+		src = BLIT_NEXT_ROW(src, src_pitch);
+	}
+}
+
+// --- AVX2 Kernels -----------------------------------------------------------------------------------------------------------------------
+
+__attribute__((target("avx2")))
+static void _blit_fill_avx2(Uint32 *dst, int dst_pitch, int w, int h, Uint32 color)
+{
+	__m256i c = _mm256_set1_epi32((int)color);
+	int x, y;
+
+	for (y = 0; y < h; y++) {
+		for (x = 0; x + 8 <= w; x += 8)
+			_mm256_storeu_si256((__m256i *)(dst + x), c);
+		_blit_fill_row(dst + x, w - x, color);
+		dst = BLIT_NEXT_ROW(dst, dst_pitch);
+	}
+}
+
+__attribute__((target("avx2")))
+static void _blit_colorkey_avx2(Uint32 *dst, int dst_pitch, const Uint32 *src, int src_pitch, int w, int h, Uint32 key, Uint32 mask)
+{
+	__m256i k = _mm256_set1_epi32((int)key);
+	__m256i m = _mm256_set1_epi32((int)mask);
+	__m256i s, d, transparent;
+	int x, y;
+
+	for (y = 0; y < h; y++) {
+		for (x = 0; x + 8 <= w; x += 8) {
+			s = _mm256_loadu_si256((const __m256i *)(src + x));
+			d = _mm256_loadu_si256((const __m256i *)(dst + x));
+			transparent = _mm256_cmpeq_epi32(_mm256_and_si256(s, m), k);
+			_mm256_storeu_si256((__m256i *)(dst + x), _mm256_blendv_epi8(s, d, transparent));
+		}
+		_blit_colorkey_row(dst + x, src + x, w - x, key, mask);
+		dst = BLIT_NEXT_ROW(dst, dst_pitch);
+		src = BLIT_NEXT_ROW(src, src_pitch);
+	}
+}
+
+__attribute__((target("avx2")))
+static void _blit_blend_avx2(Uint32 *dst, int dst_pitch, const Uint32 *src, int src_pitch, int w, int h, Uint32 key, Uint32 mask, Uint8 alpha, bool keyed)
+{
+	__m256i zero = _mm256_setzero_si256();
+	__m256i a = _mm256_set1_epi16(alpha);
+	__m256i inv = _mm256_set1_epi16(256 - alpha);
+	__m256i k = _mm256_set1_epi32((int)key);
+	__m256i m = _mm256_set1_epi32((int)mask);
+	__m256i s, d, lo, hi, r;
+	int x, y;
+
+	for (y = 0; y < h; y++) {
+		for (x = 0; x + 8 <= w; x += 8) {
+			s = _mm256_loadu_si256((const __m256i *)(src + x));
+			d = _mm256_loadu_si256((const __m256i *)(dst + x));
+
+			// Unpacking and packing both work within 128-bit lanes, so the pixels stay in order
+			lo = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(s, zero), a), _mm256_mullo_epi16(_mm256_unpacklo_epi8(d, zero), inv));
+			hi = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(s, zero), a), _mm256_mullo_epi16(_mm256_unpackhi_epi8(d, zero), inv));
+			r = _mm256_packus_epi16(_mm256_srli_epi16(lo, 8), _mm256_srli_epi16(hi, 8));
+
+			if (keyed)
+				r = _mm256_blendv_epi8(r, d, _mm256_cmpeq_epi32(_mm256_and_si256(s, m), k));
+			_mm256_storeu_si256((__m256i *)(dst + x), r);
+		}
+		_blit_blend_row(dst + x, src + x, w - x, key, mask, alpha, keyed);
+		dst = BLIT_NEXT_ROW(dst, dst_pitch);
+		src = BLIT_NEXT_ROW(src, src_pitch);
+	}
+}
+
+#endif /* BLIT_X86 */
+
+// --- Benchmark --------------------------------------------------------------------------------------------------------------------------
+
+/**
+ *  An operation measured by blit_benchmark().
+ */
+typedef enum {
+	BENCH_FILL				= 0,	/**< solid fill */
+	BENCH_COLORKEY			= 1,	/**< color keyed copy */
+	BENCH_COLORKEY_RLE		= 2,	/**< color keyed copy, SDL uses RLE acceleration */
+	BENCH_BLEND				= 3,	/**< blending with a per-surface alpha value */
+	BENCH_BLEND_COLORKEY	= 4,	/**< blending with a per-surface alpha value and a color key */
+	BENCH_OPERATIONS		= 5,	/**< number of operations */
+} BlitBenchOperation;
+
+#define BENCH_SPRITE_SIZE		60			/**< width and height of the sprite which is drawn */
+#define BENCH_ALPHA				192			/**< alpha value of the blending operations */
+#define BENCH_CHECK_BLITS		512			/**< number of blits which are compared with SDL */
+
+static char *a_bench_names[BENCH_OPERATIONS] = { "fill", "color key", "color key (RLE)", "alpha", "alpha + color key" };
+
+/**
+ *  Gets the position of the n-th sprite drawn by the benchmark. The sprites are scattered
+ *  over the surface, so they overlap each other like in a real frame.
+ */
+static void _blit_bench_position(SDL_Surface *dst, int n, SDL_Rect *rect)
+{
+	rect->x = (n * 37) % (dst->w - BENCH_SPRITE_SIZE);
+	rect->y = (n * 53) % (dst->h - BENCH_SPRITE_SIZE);
+	rect->w = BENCH_SPRITE_SIZE;
+	rect->h = BENCH_SPRITE_SIZE;
+}
+
+/**
+ *  Draws the n-th sprite of the benchmark, either by SDL or by the kernels in use.
+ */
+static void _blit_bench_draw(BlitBenchOperation op, bool sdl, SDL_Surface *src, SDL_Surface *dst, int n, Uint32 color)
+{
+	SDL_Rect rect;
+	Uint32 *pixels;
+	Uint32 key = src->format->colorkey;
+
+	_blit_bench_position(dst, n, &rect);
+
+	if (sdl) {
+		if (op == BENCH_FILL)
+			SDL_FillRect(dst, &rect, color);
+		else
+			SDL_BlitSurface(src, NULL, dst, &rect);
+		return;
+	}
+
+	pixels = (Uint32 *)((Uint8 *)dst->pixels + rect.y * dst->pitch) + rect.x;
+	switch (op) {
+		case BENCH_FILL:
+			blit_fill(pixels, dst->pitch, rect.w, rect.h, color);
+			break;
+		case BENCH_COLORKEY:
+		case BENCH_COLORKEY_RLE:
+			blit_colorkey(pixels, dst->pitch, src->pixels, src->pitch, rect.w, rect.h, key, 0xFFFFFFFF);
+			break;
+		case BENCH_BLEND:
+			blit_blend(pixels, dst->pitch, src->pixels, src->pitch, rect.w, rect.h, BENCH_ALPHA);
+			break;
+		default:
+			blit_blend_colorkey(pixels, dst->pitch, src->pixels, src->pitch, rect.w, rect.h, key, 0xFFFFFFFF, BENCH_ALPHA);
+			break;
+	}
+}
+
+/**
+ *  Fills a surface with a pattern, which contains the color key of the benchmark in about every fourth pixel.
+ */
+static void _blit_bench_pattern(SDL_Surface *surface, Uint32 seed, Uint32 key)
+{
+	Uint32 *row, value;
+	int x, y;
+
+	value = seed;
+	for (y = 0; y < surface->h; y++) {
+		row = (Uint32 *)((Uint8 *)surface->pixels + y * surface->pitch);
+		for (x = 0; x < surface->w; x++) {
+			value = value * 1103515245 + 12345;
+			row[x] = ((value >> 16) & 3) ? (value & 0x00FFFFFF) : key;
+		}
+	}
+}
+
+/**
+ *  Measures one operation implemented by SDL or by the kernels in use.
+ *
+ *  @returns		the number of pixels drawn per second
+ */
+static double _blit_bench_measure(BlitBenchOperation op, bool sdl, SDL_Surface *src, SDL_Surface *dst)
+{
+	Uint64 start, elapsed;
+	int n = 0, i;
+
+	start = time_get_ns();
+	do {
+		for (i = 0; i < 256; i++, n++)
+			_blit_bench_draw(op, sdl, src, dst, n, 0x00336699);
+		elapsed = time_get_ns() - start;
+	} while (elapsed < BLIT_BENCH_NS);
+
+	return (double)n * BENCH_SPRITE_SIZE * BENCH_SPRITE_SIZE / ((double)elapsed / 1000000000.0);
+}
+
+/**
+ *  Draws the same sprites by SDL and by the kernels in use and counts the pixels which differ.
+ */
+static long _blit_bench_check(BlitBenchOperation op, SDL_Surface *src, SDL_Surface *dst, Uint32 *expected)
+{
+	long differ = 0;
+	int n, y, x;
+
+	_blit_bench_pattern(dst, 4711, 0);
+	for (n = 0; n < BENCH_CHECK_BLITS; n++)
+		_blit_bench_draw(op, TRUE, src, dst, n, 0x00336699);
+	for (y = 0; y < dst->h; y++)
+		memcpy(expected + y * dst->w, (Uint8 *)dst->pixels + y * dst->pitch, dst->w * sizeof(Uint32));
+
+	_blit_bench_pattern(dst, 4711, 0);
+	for (n = 0; n < BENCH_CHECK_BLITS; n++)
+		_blit_bench_draw(op, FALSE, src, dst, n, 0x00336699);
+	for (y = 0; y < dst->h; y++) {
+		Uint32 *row = (Uint32 *)((Uint8 *)dst->pixels + y * dst->pitch);
+		for (x = 0; x < dst->w; x++) {
+			if (row[x] != expected[y * dst->w + x])
+				differ++;
+		}
+	}
+
+	return differ;
+}
+
+// --- Public Functions -------------------------------------------------------------------------------------------------------------------
+
+/**
+ *  Initializes this module. It detects the instruction sets supported by the processor
+ *  and chooses the fastest kernels, unless others are requested by --blit.
+ */
+void blit_init()
+{
+	char *option;
+	int i;
+
+	memset(a_kernels, 0, sizeof(a_kernels));
+	memset(a_supported, 0, sizeof(a_supported));
+
+	a_kernels[BLIT_SCALAR].fill = _blit_fill_scalar;
+	a_kernels[BLIT_SCALAR].colorkey = _blit_colorkey_scalar;
+	a_kernels[BLIT_SCALAR].blend = _blit_blend_scalar;
+	a_supported[BLIT_SCALAR] = TRUE;
+
+#ifdef BLIT_X86
+	a_kernels[BLIT_SSE2].fill = _blit_fill_sse2;
+	a_kernels[BLIT_SSE2].colorkey = _blit_colorkey_sse2;
+	a_kernels[BLIT_SSE2].blend = _blit_blend_sse2;
+	a_kernels[BLIT_AVX2].fill = _blit_fill_avx2;
+	a_kernels[BLIT_AVX2].colorkey = _blit_colorkey_avx2;
+	a_kernels[BLIT_AVX2].blend = _blit_blend_avx2;
+
+	__builtin_cpu_init();
+	a_supported[BLIT_SSE2] = __builtin_cpu_supports("sse2");
+	a_supported[BLIT_AVX2] = __builtin_cpu_supports("avx2");
+#endif
+
+	// Take the fastest kernels, or the ones given by --blit if they are supported
+	kernel = BLIT_SCALAR;
+	for (i = BLIT_KERNELS - 1; i > BLIT_SCALAR; i--) {
+		if (a_supported[i]) {
+			kernel = i;
+			break;
+		}
+	}
+
+	option = application_get_option("blit");
+	if (option) {
+		for (i = 0; i < BLIT_KERNELS; i++) {
+			if (strcmp(option, a_names[i]) == 0 && !blit_set_kernel(i))
+				fprintf(stderr, "blit kernels '%s' aren't supported, using '%s'\n", option, a_names[kernel]);
+		}
+	}
+}
+
+/**
+ *  Destroys this module.
+ */
+void blit_destroy()
+{
+}
+
+/**
+ *  Chooses the set of kernels which is used by all blit functions.
+ *
+ *  @param k		the set of kernels
+ *
+ *  @returns		TRUE if the processor supports the kernels, otherwise FALSE and the kernels aren't changed
+ */
+bool blit_set_kernel(BlitKernel k)
+{
+	if ((int)k < 0 || k >= BLIT_KERNELS || !a_supported[k])
+		return FALSE;
+
+	kernel = k;
+	return TRUE;
+}
+
+/**
+ *  Gets the set of kernels which is used by all blit functions.
+ *
+ *  @returns		the set of kernels
+ */
+BlitKernel blit_get_kernel()
+{
+	return kernel;
+}
+
+/**
+ *  Checks whether a set of kernels is compiled and supported by the processor.
+ *
+ *  @param k		the set of kernels
+ *
+ *  @returns		TRUE if the kernels can be used, otherwise FALSE
+ */
+bool blit_is_supported(BlitKernel k)
+{
+	return (int)k >= 0 && k < BLIT_KERNELS && a_supported[k];
+}
+
+/**
+ *  Gets the name of a set of kernels, as it is given to --blit.
+ *
+ *  @param k		the set of kernels
+ *
+ *  @returns		the name
+ */
+char * blit_get_kernel_name(BlitKernel k)
+{
+	return ((int)k >= 0 && k < BLIT_KERNELS) ? a_names[k] : "unknown";
+}
+
+/**
+ *  Fills a rectangle with a color.
+ *
+ *  @param dst			first pixel of the rectangle
+ *  @param dst_pitch	length of a row of the destination surface in bytes
+ *  @param w			width of the rectangle
+ *  @param h			height of the rectangle
+ *  @param color		the color in the pixel format of the surface
+ */
+void blit_fill(Uint32 *dst, int dst_pitch, int w, int h, Uint32 color)
+{
+	a_kernels[kernel].fill(dst, dst_pitch, w, h, color);
+}
+
+/**
+ *  Copies a rectangle of pixels.
+ *
+ *  @param dst			first pixel of the destination rectangle
+ *  @param dst_pitch	length of a row of the destination surface in bytes
+ *  @param src			first pixel of the source rectangle
+ *  @param src_pitch	length of a row of the source surface in bytes
+ *  @param w			width of the rectangle
+ *  @param h			height of the rectangle
+ */
+void blit_copy(Uint32 *dst, int dst_pitch, const Uint32 *src, int src_pitch, int w, int h)
+{
+	int y;
+
+	// memcpy() already uses the widest instructions available
+	for (y = 0; y < h; y++) {
+		memcpy(dst, src, w * sizeof(Uint32));
+		dst = BLIT_NEXT_ROW(dst, dst_pitch);
+		src = BLIT_NEXT_ROW(src, src_pitch);
+	}
+}
+
+/**
+ *  Copies a rectangle of pixels except the ones which have the color key.
+ *
+ *  @param dst			first pixel of the destination rectangle
+ *  @param dst_pitch	length of a row of the destination surface in bytes
+ *  @param src			first pixel of the source rectangle
+ *  @param src_pitch	length of a row of the source surface in bytes
+ *  @param w			width of the rectangle
+ *  @param h			height of the rectangle
+ *  @param key			the color key, already masked with mask
+ *  @param mask			the bits which are compared with the color key, usually all but the alpha channel
+ */
+void blit_colorkey(Uint32 *dst, int dst_pitch, const Uint32 *src, int src_pitch, int w, int h, Uint32 key, Uint32 mask)
+{
+	a_kernels[kernel].colorkey(dst, dst_pitch, src, src_pitch, w, h, key & mask, mask);
+}
+
+/**
+ *  Blends a rectangle of pixels onto another one.
+ *
+ *  @param dst			first pixel of the destination rectangle
+ *  @param dst_pitch	length of a row of the destination surface in bytes
+ *  @param src			first pixel of the source rectangle
+ *  @param src_pitch	length of a row of the source surface in bytes
+ *  @param w			width of the rectangle
+ *  @param h			height of the rectangle
+ *  @param alpha		the opacity of the source pixels
+ */
+void blit_blend(Uint32 *dst, int dst_pitch, const Uint32 *src, int src_pitch, int w, int h, Uint8 alpha)
+{
+	a_kernels[kernel].blend(dst, dst_pitch, src, src_pitch, w, h, 0, 0, alpha, FALSE);
+}
+
+/**
+ *  Blends a rectangle of pixels onto another one except the pixels which have the color key.
+ *
+ *  @param dst			first pixel of the destination rectangle
+ *  @param dst_pitch	length of a row of the destination surface in bytes
+ *  @param src			first pixel of the source rectangle
+ *  @param src_pitch	length of a row of the source surface in bytes
+ *  @param w			width of the rectangle
+ *  @param h			height of the rectangle
+ *  @param key			the color key, already masked with mask
+ *  @param mask			the bits which are compared with the color key, usually all but the alpha channel
+ *  @param alpha		the opacity of the source pixels
+ */
+void blit_blend_colorkey(Uint32 *dst, int dst_pitch, const Uint32 *src, int src_pitch, int w, int h, Uint32 key, Uint32 mask, Uint8 alpha)
+{
+	a_kernels[kernel].blend(dst, dst_pitch, src, src_pitch, w, h, key & mask, mask, alpha, TRUE);
+}
+
+/**
+ *  Compares every set of kernels supported by the processor with SDL_BlitSurface() and
+ *  SDL_FillRect(). Sprites are drawn at scattered positions into a surface of the size of
+ *  the screen for a fixed time. The results are also compared pixel by pixel with SDL.
+ */
+void blit_benchmark()
+{
+	SDL_Surface *src, *dst;
+	Uint32 *expected;
+	BlitKernel saved = kernel;
+	double sdl_rate, rate;
+	long differ;
+	int op, k;
+
+	src = SDL_CreateRGBSurface(SDL_SWSURFACE, BENCH_SPRITE_SIZE, BENCH_SPRITE_SIZE, 32, 0x00FF0000, 0x0000FF00, 0x000000FF, 0);
+	dst = SDL_CreateRGBSurface(SDL_SWSURFACE, 1024, 768, 32, 0x00FF0000, 0x0000FF00, 0x000000FF, 0);
+	assert_ptr(src, "couldn't create surface", SDL_GetError);
+	assert_ptr(dst, "couldn't create surface", SDL_GetError);
+	expected = (Uint32 *)malloc(dst->w * dst->h * sizeof(Uint32));
+
+	_blit_bench_pattern(src, 42, SDL_MapRGB(src->format, 0xFF, 0x00, 0xFF));
+
+	printf("blit benchmark: %dx%d sprites into a %dx%d surface\n", BENCH_SPRITE_SIZE, BENCH_SPRITE_SIZE, dst->w, dst->h);
+	printf("%-20s %-8s %12s %10s %s\n", "operation", "kernels", "Mpixels/s", "vs SDL", "result");
+
+	for (op = 0; op < BENCH_OPERATIONS; op++) {
+		// Set up the sprite the way SDL expects it for this operation
+		switch (op) {
+			case BENCH_COLORKEY_RLE:
+				SDL_SetColorKey(src, SDL_SRCCOLORKEY | SDL_RLEACCEL, SDL_MapRGB(src->format, 0xFF, 0x00, 0xFF));
+				SDL_SetAlpha(src, 0, 255);
+				break;
+			case BENCH_BLEND:
+				SDL_SetColorKey(src, 0, 0);
+				SDL_SetAlpha(src, SDL_SRCALPHA, BENCH_ALPHA);
+				break;
+			case BENCH_BLEND_COLORKEY:
+				SDL_SetColorKey(src, SDL_SRCCOLORKEY, SDL_MapRGB(src->format, 0xFF, 0x00, 0xFF));
+				SDL_SetAlpha(src, SDL_SRCALPHA, BENCH_ALPHA);
+				break;
+			default:
+				SDL_SetColorKey(src, SDL_SRCCOLORKEY, SDL_MapRGB(src->format, 0xFF, 0x00, 0xFF));
+				SDL_SetAlpha(src, 0, 255);
+				break;
+		}
+
+		sdl_rate = _blit_bench_measure(op, TRUE, src, dst);
+		printf("%-20s %-8s %12.1f\n", a_bench_names[op], "SDL", sdl_rate / 1000000.0);
+
+		// The kernels don't use RLE, they are compared with SDL in the plain color key operation
+		if (op == BENCH_COLORKEY_RLE)
+			continue;
+
+		for (k = 0; k < BLIT_KERNELS; k++) {
+			if (!blit_set_kernel(k))
+				continue;
+
+			rate = _blit_bench_measure(op, FALSE, src, dst);
+			differ = _blit_bench_check(op, src, dst, expected);
+			if (differ)
+				printf("%-20s %-8s %12.1f %9.2fx %ld pixels differ from SDL\n", a_bench_names[op], a_names[k], rate / 1000000.0, rate / sdl_rate, differ);
+			else
+				printf("%-20s %-8s %12.1f %9.2fx same as SDL\n", a_bench_names[op], a_names[k], rate / 1000000.0, rate / sdl_rate);
+		}
+	}
+
+	kernel = saved;
+
+	free(expected);
+	SDL_FreeSurface(src);
+	SDL_FreeSurface(dst);
+}
+
+/** @} */
@@ -0,0 +1,79 @@
+/*
+ * blit.h
+ * This file is part of Arena1
+ *
+ * Copyright (C) 2013
+ *
+ * Arena1 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Arena1 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Arena1. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+/**
+ *  @defgroup blit blit
+ *  @brief Provides fast pixel kernels for 32-bit surfaces.
+ *
+ *  This module provides the kernels which copy and blend sprites in the 32-bit display
+ *  format: solid fill, opaque copy, color keyed copy and blending with a per-surface
+ *  alpha value, with or without color key. Blending uses the formula of SDL 1.2 for
+ *  most alpha values, every channel becomes dst + (((src - dst) * alpha) >> 8).
+ *
+ *  There are kernels for SSE2 and AVX2 besides the portable scalar ones. The fastest
+ *  kernels supported by the processor are chosen at runtime when the module is
+ *  initialized. They can be overridden by --blit=scalar, --blit=sse2 or --blit=avx2.
+ *
+ *  All functions expect the rectangles to lie within both surfaces, they don't clip.
+ *  The pitches are given in bytes. blit_benchmark() compares the kernels with
+ *  SDL_BlitSurface(), it is run by passing --bench-blit.
+ *
+ *  @{
+ */
+
+#ifndef BLIT_H_
+#define BLIT_H_
+
+#include <SDL/SDL.h>
+#include "core/common.h"
+
+#define BLIT_BENCH_NS		200000000		/**< time each implementation is measured by blit_benchmark() in nanoseconds */
+
+/**
+ *  The sets of kernels.
+ */
+typedef enum {
+	BLIT_SCALAR		= 0,	/**< portable C kernels, which are always available */
+	BLIT_SSE2		= 1,	/**< kernels processing four pixels at once */
+	BLIT_AVX2		= 2,	/**< kernels processing eight pixels at once */
+	BLIT_KERNELS	= 3,	/**< number of sets of kernels */
+} BlitKernel;
+
+extern void blit_init();
+extern void blit_destroy();
+
+extern bool blit_set_kernel(BlitKernel kernel);
+extern BlitKernel blit_get_kernel();
+extern bool blit_is_supported(BlitKernel kernel);
+extern char * blit_get_kernel_name(BlitKernel kernel);
+
+extern void blit_fill(Uint32 *dst, int dst_pitch, int w, int h, Uint32 color);
+extern void blit_copy(Uint32 *dst, int dst_pitch, const Uint32 *src, int src_pitch, int w, int h);
+extern void blit_colorkey(Uint32 *dst, int dst_pitch, const Uint32 *src, int src_pitch, int w, int h, Uint32 key, Uint32 mask);
+extern void blit_blend(Uint32 *dst, int dst_pitch, const Uint32 *src, int src_pitch, int w, int h, Uint8 alpha);
+extern void blit_blend_colorkey(Uint32 *dst, int dst_pitch, const Uint32 *src, int src_pitch, int w, int h, Uint32 key, Uint32 mask, Uint8 alpha);
+
+extern void blit_benchmark();
+
+#endif /* BLIT_H_ */
+
+/** @} */
@@ -0,0 +1,249 @@
+/*
+ * clock.c
+ * This file is part of Arena1
+ *
+ * Copyright (C) 2013
+ *
+ * Arena1 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Arena1 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Arena1. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ *  @addtogroup clock
+ *  @{
+ */
+
+#include <stdlib.h>
+#include "common.h"
+#include "clock.h"
+
+
+
+/**
+ *  A struct which holds the state of a clock. The time of a running clock is
+ *  calculated from the time it had when it was started or its scale was changed last.
+ */
+typedef struct {
+	Uint64		base_ns;		/**< time of the clock when it has been rebased */
+	Uint64		base_real_ns;	/**< time of the system clock when it has been rebased */
+	float		scale;			/**< time scale or CLOCK_SCALE_UNLIMITED */
+	bool		paused;			/**< whether the clock is paused */
+} ClockInfo;
+
+static ClockInfo a_clocks[CLOCK_COUNT];	/**< state of all clocks */
+
+// --- Static Functions -------------------------------------------------------
+
+/**
+ *  Checks whether a clock follows the system clock right now.
+ *
+ *  @param info		a clock
+ *
+ *  @returns		TRUE if the clock isn't paused and its scale is positive
+ */
+static bool _clock_is_running(ClockInfo *info)
+{
+	return !info->paused && info->scale > 0.0f;
+}
+
+/**
+ *  Gets the time of a clock.
+ *
+ *  @param info		a clock
+ *  @param real_ns	the current time of the system clock
+ *
+ *  @returns		the time of the clock in nanoseconds
+ */
+static Uint64 _clock_get_ns(ClockInfo *info, Uint64 real_ns)
+{
+	if (!_clock_is_running(info))
+		return info->base_ns;
+
+	return info->base_ns + (Uint64)((double)(real_ns - info->base_real_ns) * info->scale);
+}
+
+/**
+ *  Sets the base of a clock to its current time, so that its scale or state can be changed
+ *  without a jump of its time.
+ *
+ *  @param info		a clock
+ */
+static void _clock_rebase(ClockInfo *info)
+{
+	Uint64 real_ns = time_get_ns();
+
+	info->base_ns = _clock_get_ns(info, real_ns);
+	info->base_real_ns = real_ns;
+}
+
+// --- Public Functions -------------------------------------------------------
+
+/**
+ *  Initializes this module. The real clock starts with the time of the system clock,
+ *  all other clocks start at 0 with a time scale of 1.
+ */
+void clock_init()
+{
+	Uint64 real_ns = time_get_ns();
+	int i;
+
+	for (i = 0; i < CLOCK_COUNT; i++) {
+		a_clocks[i].base_ns = (i == CLOCK_REAL) ? real_ns : 0;
+		a_clocks[i].base_real_ns = real_ns;
+		a_clocks[i].scale = 1.0f;
+		a_clocks[i].paused = FALSE;
+	}
+}
+
+/**
+ *  Destroys this module.
+ */
+void clock_destroy()
+{
+}
+
+/**
+ *  Gets the current time of a clock.
+ *
+ *  @param clock	a clock
+ *
+ *  @returns		the time in nanoseconds
+ */
+Uint64 clock_get_ns(Clock clock)
+{
+	if (clock == CLOCK_REAL)
+		return time_get_ns();
+
+	return _clock_get_ns(&a_clocks[clock], time_get_ns());
+}
+
+/**
+ *  Sets the time scale of a clock. The real clock can't be scaled.
+ *
+ *  @param clock	a clock
+ *  @param scale	the new time scale, 0 stops the clock, CLOCK_SCALE_UNLIMITED lets it run as fast as possible
+ */
+void clock_set_scale(Clock clock, float scale)
+{
+	if (clock == CLOCK_REAL)
+		return;
+
+	if (scale < 0.0f)
+		scale = CLOCK_SCALE_UNLIMITED;
+
+	_clock_rebase(&a_clocks[clock]);
+	a_clocks[clock].scale = scale;
+}
+
+/**
+ *  Gets the time scale of a clock.
+ *
+ *  @param clock	a clock
+ *
+ *  @returns		the time scale or CLOCK_SCALE_UNLIMITED
+ */
+float clock_get_scale(Clock clock)
+{
+	return a_clocks[clock].scale;
+}
+
+/**
+ *  Pauses or resumes a clock. In contrast to the time scale 0 the time scale is kept,
+ *  so the clock continues with the same speed when it is resumed. The real clock
+ *  can't be paused.
+ *
+ *  @param clock	a clock
+ *  @param paused	TRUE to pause the clock, FALSE to resume it
+ */
+void clock_set_paused(Clock clock, bool paused)
+{
+	if (clock == CLOCK_REAL || a_clocks[clock].paused == paused)
+		return;
+
+	_clock_rebase(&a_clocks[clock]);
+	a_clocks[clock].paused = paused;
+}
+
+/**
+ *  Checks whether a clock is stopped, either because it is paused or because its time scale is 0.
+ *
+ *  @param clock	a clock
+ *
+ *  @returns		TRUE if the time of the clock doesn't change
+ */
+bool clock_is_paused(Clock clock)
+{
+	return a_clocks[clock].paused || a_clocks[clock].scale == 0.0f;
+}
+
+/**
+ *  Checks whether a clock runs as fast as possible.
+ *
+ *  @param clock	a clock
+ *
+ *  @returns		TRUE if the clock isn't paused and has the time scale CLOCK_SCALE_UNLIMITED
+ */
+bool clock_is_unlimited(Clock clock)
+{
+	return !a_clocks[clock].paused && a_clocks[clock].scale < 0.0f;
+}
+
+/**
+ *  Moves a clock forward. This is only done for unlimited clocks, which don't follow
+ *  the system clock.
+ *
+ *  @param clock	a clock
+ *  @param ns		the new time of the clock in nanoseconds, it is ignored if it is in the past
+ */
+void clock_advance(Clock clock, Uint64 ns)
+{
+	if (!clock_is_unlimited(clock))
+		return;
+
+	if (ns > a_clocks[clock].base_ns)
+		a_clocks[clock].base_ns = ns;
+}
+
+/**
+ *  Gets the time of the system clock at which a clock reaches a specified time.
+ *
+ *  @param clock	a clock
+ *  @param ns		a time of the clock in nanoseconds
+ *
+ *  @returns		the time in nanoseconds (see time_get_ns()), the current time if the clock
+ *  				is unlimited or has already passed it, or 0 if the clock is stopped
+ */
+Uint64 clock_get_real_ns(Clock clock, Uint64 ns)
+{
+	ClockInfo *info = &a_clocks[clock];
+	Uint64 real_ns = time_get_ns();
+	Uint64 now;
+
+	if (clock == CLOCK_REAL)
+		return ns;
+
+	if (clock_is_unlimited(clock))
+		return real_ns;
+
+	if (!_clock_is_running(info))
+		return 0;
+
+	now = _clock_get_ns(info, real_ns);
+	if (ns <= now)
+		return real_ns;
+
+	return real_ns + (Uint64)((double)(ns - now) / info->scale);
+}
+
+/** @} */
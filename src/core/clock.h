@@ -0,0 +1,69 @@
+/*
+ * clock.h
+ * This file is part of Arena1
+ *
+ * Copyright (C) 2013
+ *
+ * Arena1 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Arena1 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Arena1. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ *  @defgroup clock clock
+ *  @brief Provides the clocks which drive the timers.
+ *
+ *  This module provides two clocks. The real clock follows the monotonic system
+ *  clock (see time_get_ns()) and drives everything which has to keep pace with the
+ *  display, like drawing. The game clock drives the simulation. It can be paused and
+ *  its speed can be changed by a time scale, e.g. 0.25 for slow motion or 8 for
+ *  fast-forward, without affecting the real clock.
+ *
+ *  With the time scale CLOCK_SCALE_UNLIMITED the game clock doesn't follow the system
+ *  clock at all. Instead it is moved forward by clock_advance() as fast as the timers
+ *  attached to it can be processed (see the timer module).
+ *
+ *  @{
+ */
+
+#ifndef CLOCK_H_
+#define CLOCK_H_
+
+#include "common.h"
+
+#define CLOCK_SCALE_UNLIMITED	-1.0f		/**< time scale of a clock which runs as fast as possible */
+
+/**
+ *  The available clocks.
+ */
+typedef enum {
+	CLOCK_REAL = 0x00,		/**< the real clock, which always runs at the speed of the system clock */
+	CLOCK_GAME = 0x01,		/**< the game clock, which can be paused and scaled */
+	CLOCK_COUNT				/**< number of clocks */
+} Clock;
+
+extern void clock_init();
+extern void clock_destroy();
+
+extern Uint64 clock_get_ns(Clock clock);
+extern void clock_set_scale(Clock clock, float scale);
+extern float clock_get_scale(Clock clock);
+extern void clock_set_paused(Clock clock, bool paused);
+extern bool clock_is_paused(Clock clock);
+extern bool clock_is_unlimited(Clock clock);
+extern void clock_advance(Clock clock, Uint64 ns);
+extern Uint64 clock_get_real_ns(Clock clock, Uint64 ns);
+
+#endif /* CLOCK_H_ */
+
+/** @} */
@@ -26,7 +26,9 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <math.h>
+#include <time.h>
 #include <SDL/SDL.h>
 #include <SDL/SDL_image.h>
 #include <SDL/SDL_mixer.h>
@@ -35,6 +37,9 @@
 
 
 char		*app_path;
+int			 app_argc;
+char	   **app_argv;
+bool		 app_headless;
 
 /**
  *  A helper function which gets the path of the application.
@@ -71,8 +76,18 @@ char * _get_app_path(char *arg0)
  */
 void common_init(int argc, char *argv[])
 {
-	// Get path of application for further use
+	// Get path of application and keep the arguments for further use
 	app_path = _get_app_path(argv[0]);
+	app_argc = argc;
+	app_argv = argv;
+	app_headless = application_get_option("headless") != NULL;
+
+	if (app_headless) {
+		// Without a window SDL still needs a video driver for its event queue
+		SDL_putenv("SDL_VIDEODRIVER=dummy");
+		assert_ret(SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER), 0, "couldn't initialize SDL", SDL_GetError);
+		return;
+	}
 
 	// Initialize SDL and open mixer API
 	assert_ret(SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO | SDL_INIT_TIMER), 0, "couldn't initialize SDL", SDL_GetError);
@@ -90,8 +105,10 @@ void common_destroy()
 {
 	free(app_path);
 
-	Mix_CloseAudio();
-	TTF_Quit();
+	if (!app_headless) {
+		Mix_CloseAudio();
+		TTF_Quit();
+	}
 	SDL_Quit();
 }
 
@@ -107,6 +124,50 @@ char * application_get_path()
 	return app_path;
 }
 
+/**
+ *  Gets the value of a command line option. An option is passed either as "--name=value"
+ *  or as "--name" without a value. If an option is passed several times, the last one counts.
+ *
+ *  @attention Don't modify or free this string!
+ *
+ *  @param name		name of the option without the leading dashes
+ *
+ *  @returns		the value, an empty string if the option has no value or NULL if it hasn't been passed
+ */
+char * application_get_option(char *name)
+{
+	char *value = NULL;
+	char *arg;
+	int len = strlen(name);
+	int i;
+
+	for (i = 1; i < app_argc; i++) {
+		arg = app_argv[i];
+
+		if (strncmp(arg, "--", 2) != 0 || strncmp(arg + 2, name, len) != 0)
+			continue;
+
+		if (arg[len + 2] == '=')
+			value = arg + len + 3;
+		else if (arg[len + 2] == '\0')
+			value = arg + len + 2;
+	}
+
+	return value;
+}
+
+/**
+ *  Checks whether the application runs without a window and without audio. This is the case if
+ *  the option --headless has been passed. Then no sprites, fonts and samples are loaded
+ *  (see assert_sprite(), assert_font() and assert_sample()) and nothing is rendered or played.
+ *
+ *  @returns		TRUE if the application runs headless, otherwise FALSE
+ */
+bool application_is_headless()
+{
+	return app_headless;
+}
+
 /**
  *  Puts a poison pill into the SDL event queue so that the application quits soon.
  */
@@ -154,6 +215,35 @@ void assert_ptr(void *ptr, char *msg, char *(*err_msg)())
 	}
 }
 
+/**
+ *  Gets the current time of a monotonic clock with a high resolution. The clock
+ *  isn't affected by changes of the system time, so it is suitable to measure durations.
+ *
+ *  @returns		the time in nanoseconds since an arbitrary point in the past
+ */
+Uint64 time_get_ns()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (Uint64)ts.tv_sec * 1000000000ULL + (Uint64)ts.tv_nsec;
+}
+
+/**
+ *  Suspends the calling thread for the specified duration. The thread may
+ *  sleep a bit longer depending on the resolution of the system timer.
+ *
+ *  @param ns		duration in nanoseconds
+ */
+void time_sleep_ns(Uint64 ns)
+{
+	struct timespec ts;
+
+	ts.tv_sec = ns / 1000000000ULL;
+	ts.tv_nsec = ns % 1000000000ULL;
+	nanosleep(&ts, NULL);
+}
+
 /**
  *  A convenience function to get a random number matching a specified interval.
  *
@@ -209,6 +299,21 @@ VectorF vrect(float x, float y)
 	return v;
 }
 
+/**
+ *  Interpolates linearly between two floating point vectors.
+ *
+ *  @param a		first vector
+ *  @param b		second vector
+ *  @param t		weight of the second vector, 0 returns a and 1 returns b
+ *
+ *  @returns		the interpolated vector
+ */
+VectorF vlerp(VectorF a, VectorF b, float t)
+{
+	VectorF v = { a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t };
+	return v;
+}
+
 /**
  *  Loads a TTF font file. The application is exited if
  *  the font file couldn't be loaded.
@@ -218,10 +323,13 @@ VectorF vrect(float x, float y)
  *  @param file		file name of the TTF font file
  *  @param ptsize	size of the font
  *
- *  @returns		the loaded font
+ *  @returns		the loaded font or NULL if the application runs headless
  */
 TTF_Font * assert_font(char *file, int ptsize)
 {
+	if (app_headless)
+		return NULL;
+
 	char *path = malloc(strlen(app_path) + strlen(file) + 1);
 	strcpy(path, app_path);
 	strcat(path, file);
@@ -242,10 +350,13 @@ TTF_Font * assert_font(char *file, int ptsize)
  *
  *  @param file		file name of the audio file
  *
- *  @returns		the loaded sample
+ *  @returns		the loaded sample or NULL if the application runs headless
  */
 Mix_Chunk * assert_sample(char *file)
 {
+	if (app_headless)
+		return NULL;
+
 	char *path = malloc(strlen(app_path) + strlen(file) + 1);
 	strcpy(path, app_path);
 	strcat(path, file);
@@ -258,6 +369,18 @@ Mix_Chunk * assert_sample(char *file)
 	return sample;
 }
 
+/**
+ *  Plays an audio sample once on the first free channel. Nothing is played
+ *  if the application runs headless.
+ *
+ *  @param sample	an audio sample loaded by assert_sample()
+ */
+void sample_play(Mix_Chunk *sample)
+{
+	if (sample)
+		Mix_PlayChannel(-1, sample, 0);
+}
+
 /**
  *  Loads a sprite file. The application is exited if
  *  the sprite file couldn't be loaded.
@@ -266,17 +389,21 @@ Mix_Chunk * assert_sample(char *file)
  *
  *  @param file		file name of the sprite file
  *
- *  @returns		the loaded sprite file
+ *  @returns		the loaded sprite file or NULL if the application runs headless
  */
 SDL_Surface * assert_sprite(char *file)
 {
+	if (app_headless)
+		return NULL;
+
 	char *path = malloc(strlen(app_path) + strlen(file) + 1);
 	strcpy(path, app_path);
 	strcat(path, file);
 
 	SDL_Surface *tmp = IMG_Load(path);
 	assert_ptr(tmp, "couldn't load sprite", IMG_GetError);
-	SDL_SetColorKey(tmp, SDL_SRCCOLORKEY | SDL_RLEACCEL, SDL_MapRGB(tmp->format, 0xFF, 0x00, 0xFF));
+	// No RLE acceleration, so the pixels can be read by the rasterizer of the gfx module
+	SDL_SetColorKey(tmp, SDL_SRCCOLORKEY, SDL_MapRGB(tmp->format, 0xFF, 0x00, 0xFF));
 
 	SDL_Surface *sprite;
 	sprite = SDL_DisplayFormat(tmp);
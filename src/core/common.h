@@ -77,12 +77,17 @@ extern void common_init(int argc, char *argv[]);
 extern void common_destroy();
 
 extern char * application_get_path();
+extern char * application_get_option(char *name);
+extern bool application_is_headless();
 extern void application_quit();
 
 
 extern void assert_ret(int retval, int noerror, char *msg, char *(*err_msg)());
 extern void assert_ptr(void *ptr, char *msg, char *(*err_msg)());
 
+extern Uint64 time_get_ns();
+extern void time_sleep_ns(Uint64 ns);
+
 extern int rand2(int min, int max);
 extern int fround(float value);
 
@@ -90,6 +95,7 @@ extern int fround(float value);
 
 extern Vector vrecti(int x, int y);
 extern VectorF vrect(float x, float y);
+extern VectorF vlerp(VectorF a, VectorF b, float t);
 
 // --- Text functions ---
 
@@ -98,6 +104,7 @@ extern TTF_Font * assert_font(char *file, int ptsize);
 // --- Audio functions ---
 
 extern Mix_Chunk * assert_sample(char *file);
+extern void sample_play(Mix_Chunk *sample);
 
 // --- Sprite functions ---
 
@@ -25,9 +25,13 @@
  */
 
 #include "common.h"
+#include "pool.h"
+#include "clock.h"
 #include "event.h"
 #include "timer.h"
+#include "group.h"
 #include "scene.h"
+#include "loop.h"
 #include "core.h"
 
 
@@ -38,19 +42,31 @@
 void core_init(int argc, char *argv[])
 {
 #ifdef DEBUG
+	pool_init();
+	printf("-> pool initialized.\n");
 	common_init(argc, argv);
 	printf("-> common initialized.\n");
+	clock_init();
+	printf("-> clock initialized.\n");
 	event_init();
 	printf("-> event initialized.\n");
 	timer_init();
 	printf("-> timer initialized.\n");
+	group_init();
+	printf("-> group initialized.\n");
 	scene_init();
 	printf("-> scene initialized.\n");
+	loop_init();
+	printf("-> loop initialized.\n");
 #else
+	pool_init();
 	common_init(argc, argv);
+	clock_init();
 	event_init();
 	timer_init();
+	group_init();
 	scene_init();
+	loop_init();
 #endif
 }
 
@@ -60,19 +76,32 @@ void core_init(int argc, char *argv[])
 void core_destroy()
 {
 #ifdef DEBUG
+	loop_destroy();
+	printf("-> loop destroyed.\n");
 	scene_destroy();
 	printf("-> scene destroyed.\n");
+	group_destroy();
+	printf("-> group destroyed.\n");
 	timer_destroy();
 	printf("-> timer destroyed.\n");
 	event_destroy();
 	printf("-> event destroyed.\n");
+	clock_destroy();
+	printf("-> clock destroyed.\n");
 	common_destroy();
 	printf("-> common destroyed.\n");
+	pool_print_stats();
+	pool_destroy();
+	printf("-> pool destroyed.\n");
 #else
+	loop_destroy();
 	scene_destroy();
+	group_destroy();
 	timer_destroy();
 	event_destroy();
+	clock_destroy();
 	common_destroy();
+	pool_destroy();
 #endif
 }
 
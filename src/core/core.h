@@ -33,10 +33,19 @@
 #define CORE_H_
 
 #include "common.h"
+#include "pool.h"
 #include "list.h"
+#include "ilist.h"
+#include "slotmap.h"
+#include "hashmap.h"
+#include "histogram.h"
+#include "mpsc.h"
 #include "event.h"
+#include "clock.h"
 #include "timer.h"
+#include "group.h"
 #include "scene.h"
+#include "loop.h"
 
 extern void core_init();
 extern void core_destroy();
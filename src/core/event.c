@@ -27,23 +27,24 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include "common.h"
+#include "slotmap.h"
+#include "hashmap.h"
+#include "histogram.h"
+#include "mpsc.h"
 #include "list.h"
+#include "pool.h"
+#include "group.h"
 #include "event.h"
 
 
 
 #define EVENT_NAME_MAX_LENGTH		32		/**< the maximum length of an event name (including null-terminator) */
+#define EVENT_QUEUE_SIZE			4096	/**< initial size in bytes of a queue for posted events */
+#define EVENT_QUEUE_ALIGN			8		/**< alignment of the payloads in a queue for posted events */
+#define EVENT_ASYNC_QUEUE_SIZE		1024	/**< number of events which can be posted from other threads before they are dispatched */
 
-/**
- *  A struct which holds several informations about an event.
- *
- *  @private
- */
-typedef struct {
-	char			 	 name[EVENT_NAME_MAX_LENGTH];	/**< name of the event */
-	unsigned long	 	 raise_count;					/**< number of times this event was raised */
-	List				*l_event_handlers;				/**< list containing event handler informations */
-} EventInfo;
+typedef struct _EventInfo EventInfo;
 
 /**
  *  A struct which holds several informations about an event handler.
@@ -56,113 +57,222 @@ typedef struct {
 	EventInfo			*event;			/**< event to which this event handler belongs to */
 	EventHandler 	 	 handler;		/**< a pointer to the event handler function itself */
 	EventHandlerState	 state;			/**< current state of this handler */
+	int					 group;			/**< group to which this event handler belongs to */
+	bool				 removed;		/**< whether the event handler has been disconnected while its event was raised */
 	void 				*user_data;		/**< user supplied data which is passed to the event handler */
+	Histogram			 stats;			/**< statistics about the time spent in the event handler function */
 } EventHandlerInfo;
 
-static List 	*l_events = NULL;		/**< list which contains all existing events */
-static int		 next_id = 1;			/**< the id of the next event handler created by the event_connect() function */
+/**
+ *  A struct which holds several informations about an event.
+ *
+ *  @private
+ */
+struct _EventInfo {
+	int					 id;							/**< id of the event (index in a_events plus one) */
+	char			 	 name[EVENT_NAME_MAX_LENGTH];	/**< name of the event */
+	unsigned long	 	 raise_count;					/**< number of times this event was raised */
+	EventHandlerInfo   **handlers;						/**< array of event handlers sorted by descending priority */
+	int					 n_handlers;					/**< number of event handlers in the array */
+	int					 handlers_size;					/**< number of allocated elements of the array */
+	EventHandlerInfo   **active;						/**< cached array of the event handlers which are enabled and belong to an active group */
+	int					 n_active;						/**< number of event handlers in the cached array */
+	int					 active_size;					/**< number of allocated elements of the cached array */
+	unsigned int		 active_version;				/**< value of handlers_version when the cached array was built */
+	unsigned int		 active_group_version;			/**< value of group_get_version() when the cached array was built */
+	int					 dispatching;					/**< number of nested calls of event_raise_id() for this event */
+};
+
+/**
+ *  The header of a posted event in an event queue. It is followed by a copy of the payload.
+ *
+ *  @private
+ */
+typedef struct {
+	int					 event;			/**< id of the posted event */
+	int					 size;			/**< size of the payload in bytes */
+} EventQueueEntry;
+
+/**
+ *  A queue which holds posted events until they are dispatched.
+ *
+ *  @private
+ */
+typedef struct {
+	char				*buffer;		/**< the entries and their payloads */
+	int					 length;		/**< number of bytes used */
+	int					 size;			/**< number of bytes allocated */
+} EventQueue;
+
+static EventInfo **a_events = NULL;		/**< array which contains all existing events, indexed by event id minus one */
+static int		 n_events = 0;			/**< number of events in the a_events array */
+static int		 events_size = 0;		/**< number of allocated elements of the a_events array */
+static HashMap	*m_events = NULL;		/**< map which holds all existing events by their name */
+static SlotMap	*m_handlers = NULL;		/**< map which hands out the ids of all existing event handlers */
+static unsigned int handlers_version = 1;	/**< incremented whenever an event handler is connected, disconnected or changed */
+static int		 dispatch_depth = 0;	/**< number of nested calls of event_raise_id() */
+static List		*l_removed = NULL;		/**< event handlers which have been disconnected while their event was raised */
+
+static EventQueue a_queues[2];			/**< queues for posted events, one is filled while the other one is dispatched */
+static int		 queue_post = 0;		/**< index of the queue new events are posted to */
+
+static MpscQueue *q_async = NULL;		/**< queue for events posted from other threads */
 
 // --- Static Functions -------------------------------------------------------
 
 /**
- *  A compare function used to find an event with list_find_custom().
+ *  Gets the EventInfo of a specified event.
+ *
+ *  @param event	id of the event
+ *
+ *  @returns		the EventInfo or NULL if the id is invalid.
  */
-static int _event_find_event(void *event, void *name)
+static EventInfo * _event_get_event(int event)
 {
-	return strcmp(((EventInfo *)event)->name, (char *)name);
+	if (event < 1 || event > n_events)
+		return NULL;
+
+	return a_events[event - 1];
 }
 
 /**
- *  A compare function used to find an event handler with list_find_custom().
+ *  Searches the id of an event by its name.
+ *
+ *  @param name		name of the event
+ *
+ *  @returns		the id of the event or 0 if it couldn't be found.
  */
-static int _event_find_handler(void *handler, void *id)
+static int _event_find_event(char *name)
 {
-	return ((EventHandlerInfo *)handler)->id - *((int *)id);
+	EventInfo *event;
+
+	event = (EventInfo *)hashmap_lookup_str(m_events, name);
+
+	return (event) ? event->id : 0;
 }
 
 /**
- *  A compare function used to insert event handlers with list_insert_sorted().
+ *  Gets the index of an event handler in the handler array of its event.
+ *
+ *  @param handler	an event handler
+ *
+ *  @returns		the index or -1 if it couldn't be found.
  */
-static int _event_insert_handler(void *a, void *b)
+static int _event_get_handler_index(EventHandlerInfo *handler)
 {
-	return ((EventHandlerInfo *)b)->priority - ((EventHandlerInfo *)a)->priority;
+	EventInfo *event = handler->event;
+	int i;
+
+	for (i = 0; i < event->n_handlers; i++) {
+		if (event->handlers[i] == handler)
+			return i;
+	}
+
+	return -1;
 }
 
 /**
- *  Gets the list element in the l_events list which holds the EventInfo of a specified event.
+ *  Gets the EventHandlerInfo of a specified event handler.
  *
- *  @param name		name of the event
+ *  @param id		id of the event handler
  *
- *  @returns		the list element or NULL if it couldn't be found.
+ *  @returns		the EventHandlerInfo or NULL if the id is invalid or stale.
  */
-static List * _event_get_event_link(char *name)
+static EventHandlerInfo * _event_get_handler(int id)
 {
-	return list_find_custom(l_events, name, _event_find_event);
+	return (EventHandlerInfo *)slotmap_get(m_handlers, id);
 }
 
 /**
- *  Gets the EventInfo of a specified event stored in the l_events list.
+ *  Inserts an event handler into the handler array of its event. The array is kept
+ *  sorted by descending priority, a new handler is inserted in front of the handlers
+ *  with the same priority.
  *
- *  @param name		name of the event
- *
- *  @returns		the EventInfo or NULL if it couldn't be found.
+ *  @param handler	the event handler to insert
  */
-static EventInfo * _event_get_event(char *name)
+static void _event_insert_handler(EventHandlerInfo *handler)
 {
-	List *link;
+	EventInfo *event = handler->event;
+	int i;
+
+	// Grow the array if it is full
+	if (event->n_handlers == event->handlers_size) {
+		event->handlers_size = (event->handlers_size) ? event->handlers_size * 2 : 4;
+		event->handlers = (EventHandlerInfo **)realloc(event->handlers, event->handlers_size * sizeof(EventHandlerInfo *));
+	}
+
+	// Find the position, the first handler with a lower or equal priority
+	for (i = 0; i < event->n_handlers; i++) {
+		if (event->handlers[i]->priority <= handler->priority)
+			break;
+	}
 
-	// Use function to get the link and then return its data.
-	link = _event_get_event_link(name);
-	return (link) ? (EventInfo *)link->data : NULL;
+	// Make room and insert the handler
+	memmove(&event->handlers[i + 1], &event->handlers[i], (event->n_handlers - i) * sizeof(EventHandlerInfo *));
+	event->handlers[i] = handler;
+	event->n_handlers++;
 }
 
 /**
- *  Gets the list element in the l_event_handlers list of the owning event which holds the
- *  EventHandlerInfo of a specified event handler.
+ *  Checks whether an event handler is called if its event is raised, which means
+ *  it is enabled, it belongs to an active group and it hasn't been disconnected.
  *
- *  @param id		id of the event handler
+ *  @param handler	an event handler
  *
- *  @returns		the list element or NULL if it couldn't be found.
+ *  @returns		TRUE, if the event handler is active
  */
-static List * _event_get_handler_link(int id)
+static bool _event_handler_is_active(EventHandlerInfo *handler)
 {
-	List *event_link;
-	List *handler_link;
+	return !handler->removed && handler->state == EVENT_HANDLER_ENABLED && group_is_active(handler->group);
+}
 
-	EventInfo *event;
+/**
+ *  Checks whether the cached array of active event handlers of an event is out of date.
+ *
+ *  @param event	an event
+ *
+ *  @returns		TRUE, if the array has to be rebuilt
+ */
+static bool _event_is_stale(EventInfo *event)
+{
+	return event->active_version != handlers_version || event->active_group_version != group_get_version();
+}
 
-	// Iterate through all events
-	event_link = list_first(l_events);
-	while (event_link) {
-		event = (EventInfo *)event_link->data;
+/**
+ *  Rebuilds the cached array of active event handlers of an event. Its order
+ *  is the same as the order of the handler array.
+ *
+ *  @param event	an event
+ */
+static void _event_rebuild_active(EventInfo *event)
+{
+	int i;
 
-		// Try to find the event handler in the list of this event
-		handler_link = list_find_custom(event->l_event_handlers, &id, _event_find_handler);
-		if (handler_link)
-			return handler_link;
+	// The cached array can never become larger than the handler array
+	if (event->active_size < event->handlers_size) {
+		event->active_size = event->handlers_size;
+		event->active = (EventHandlerInfo **)realloc(event->active, event->active_size * sizeof(EventHandlerInfo *));
+	}
 
-		event_link = list_next(event_link);
+	event->n_active = 0;
+	for (i = 0; i < event->n_handlers; i++) {
+		if (_event_handler_is_active(event->handlers[i]))
+			event->active[event->n_active++] = event->handlers[i];
 	}
 
-	// We couldn't find it.
-	return NULL;
+	event->active_version = handlers_version;
+	event->active_group_version = group_get_version();
 }
 
 /**
- *  Gets the EventHandlerInfo of a specified event handler stored in the l_event_handlers
- *  list of any event in the l_events list.
- *
- *  @param			id of the event handler
+ *  Frees an event handler. Used to free the handlers which
+ *  have been disconnected while their event was raised.
  *
- *  @returns		the EventHandlerInfo or NULL if it couldn't be found.
+ *  @param data		EventHandlerInfo of the event handler
  */
-static EventHandlerInfo * _event_get_handler(int id)
+static void _event_free_handler(void *data)
 {
-	List *link;
-
-	// Use function to get the link and then return its data.
-	link = _event_get_handler_link(id);
-	return (link) ? (EventHandlerInfo *)link->data : NULL;
+	pool_free(data, sizeof(EventHandlerInfo));
 }
 
 // --- Public Functions -------------------------------------------------------
@@ -172,10 +282,21 @@ static EventHandlerInfo * _event_get_handler(int id)
  */
 void event_init()
 {
-	// We don't have to do something here. This function is just to adhere to
-	// our convention that every module must have an init() and a destroy()
-	// function.
-	return;
+	int i;
+
+	// Create the maps for the event names and the event handler ids
+	m_events = hashmap_new_str();
+	m_handlers = slotmap_new();
+
+	// Preallocate the queues for posted events
+	for (i = 0; i < 2; i++) {
+		a_queues[i].buffer = (char *)malloc(EVENT_QUEUE_SIZE);
+		a_queues[i].length = 0;
+		a_queues[i].size = EVENT_QUEUE_SIZE;
+	}
+
+	// Create the queue for events from other threads
+	q_async = mpsc_new(EVENT_ASYNC_QUEUE_SIZE);
 }
 
 /**
@@ -183,22 +304,100 @@ void event_init()
  */
 void event_destroy()
 {
-	List *link;
 	EventInfo *event;
+	int i, j;
 
 	// Iterate through all events
-	link = list_first(l_events);
-	while (link) {
-		event = (EventInfo *)link->data;
+	for (i = 0; i < n_events; i++) {
+		event = a_events[i];
+
+		// Free all handlers and the handler array
+		for (j = 0; j < event->n_handlers; j++)
+			_event_free_handler(event->handlers[j]);
+		free(event->handlers);
+		free(event->active);
+
+		free(event);
+	}
+
+	// Free the array and the map of events
+	free(a_events);
+	a_events = NULL;
+	n_events = events_size = 0;
+	hashmap_free(m_events);
+	m_events = NULL;
+
+	// Free the event handlers which are still waiting to be freed
+	list_free_full(l_removed, _event_free_handler);
+	l_removed = NULL;
+
+	// Free the map of the event handler ids
+	slotmap_free(m_handlers);
+	m_handlers = NULL;
+
+	// Free the queues for posted events
+	for (i = 0; i < 2; i++) {
+		free(a_queues[i].buffer);
+		a_queues[i].buffer = NULL;
+		a_queues[i].length = a_queues[i].size = 0;
+	}
+
+	// Free the queue for events from other threads
+	mpsc_free(q_async);
+	q_async = NULL;
+}
+
+/**
+ *  Registers an event and returns its id. If the event already exists, the id of the
+ *  existing event is returned. The id can be used with event_connect_id() and
+ *  event_raise_id() which avoid looking up the event by its name.
+ *
+ *  @note		Events which are raised often should be registered once during initialization
+ *  			and raised by their id.
+ *
+ *  @param name		name of the event
+ *
+ *  @returns		the id of the event or 0 if the name is too long
+ */
+int event_register(char *name)
+{
+	EventInfo *event;
+	int id;
+
+	// Check whether the passed name is too long for our struct.
+	if (strlen(name) > EVENT_NAME_MAX_LENGTH - 1)
+		return 0;
 
-		// Clear the entire list of handlers, freeing the data too.
-		list_free_full(event->l_event_handlers, free);
+	// Does the event already exist?
+	id = _event_find_event(name);
+	if (id)
+		return id;
 
-		link = list_next(link);
+	// Grow the array if it is full
+	if (n_events == events_size) {
+		events_size = (events_size) ? events_size * 2 : 16;
+		a_events = (EventInfo **)realloc(a_events, events_size * sizeof(EventInfo *));
 	}
 
-	// Clear the entire list of events, freeing the data too.
-	list_free_full(l_events, free);
+	// Create a new event
+	event = (EventInfo *)malloc(sizeof(EventInfo));
+	event->id = n_events + 1;
+	strcpy(event->name, name);
+	event->raise_count = 0;
+	event->handlers = NULL;
+	event->n_handlers = 0;
+	event->handlers_size = 0;
+	event->active = NULL;
+	event->n_active = 0;
+	event->active_size = 0;
+	event->active_version = 0;
+	event->active_group_version = 0;
+	event->dispatching = 0;
+
+	a_events[n_events++] = event;
+	hashmap_insert_str(m_events, event->name, event);
+
+	return event->id;
 }
 
 /**
@@ -206,6 +405,25 @@ void event_destroy()
  *  this function will be called anytime the event_raise() function is called
  *  for this event.
  *
+ *  This is a convenience wrapper around event_register() and event_connect_id().
+ *
+ *  @param name				name of the event
+ *  @param priority			a priority value
+ *  @param handler			pointer to the event handler function
+ *  @param user_data		data which will be passed to the event handler function
+ *  @param handler_state	the initial state of this event handler
+ *
+ *  @returns				the id of the new event handler or 0 if the name is too long
+ */
+int event_connect(char *name, int priority, EventHandler handler, void *user_data, EventHandlerState handler_state)
+{
+	return event_connect_id(event_register(name), priority, handler, user_data, handler_state);
+}
+
+/**
+ *  Connects an event handler function to an event specified by its id. If the event
+ *  handler is enabled, this function will be called anytime the event is raised.
+ *
  *  @attention	Under no circumstances the event handler function should block for a long time
  *  			because no other events can be processed as long as an event handler is running!
  *
@@ -213,43 +431,38 @@ void event_destroy()
  *  			In order to use this functionality properly a convention for this event should
  *  			be made. If there is no convention, you should use 0 as priority.
  *
- *  @param name				name of the event
+ *  @param event			id of the event as returned by event_register()
  *  @param priority			a priority value
  *  @param handler			pointer to the event handler function
  *  @param user_data		data which will be passed to the event handler function
  *  @param handler_state	the initial state of this event handler
  *
- *  @returns				the id of the new event handler
+ *  @returns				the id of the new event handler or 0 if the event id is invalid
  */
-int event_connect(char *name, int priority, EventHandler handler, void *user_data, EventHandlerState handler_state)
+int event_connect_id(int event, int priority, EventHandler handler, void *user_data, EventHandlerState handler_state)
 {
-	EventInfo *event;
+	EventInfo *event_info;
 
-	// Check whether the passed name is too long for our struct.
-	if (strlen(name) > EVENT_NAME_MAX_LENGTH - 1)
+	// Get the event the caller wants to connect to.
+	event_info = _event_get_event(event);
+	if (!event_info)
 		return 0;
 
-	// Get the event the caller want to connect to. If we can't find it, we create a new one.
-	event = _event_get_event(name);
-	if (!event) {
-		event = (EventInfo *)malloc(sizeof(EventInfo));
-		strcpy(event->name, name);
-		event->l_event_handlers = NULL;
-		event->raise_count = 0;
-		l_events = list_append(l_events, event);
-	}
-
 	// Initialize a new struct containing information about the event handler.
-	EventHandlerInfo *handler_info = (EventHandlerInfo *)malloc(sizeof(EventHandlerInfo));
-	handler_info->id = next_id++;
+	EventHandlerInfo *handler_info = (EventHandlerInfo *)pool_alloc(sizeof(EventHandlerInfo));
+	handler_info->id = slotmap_insert(m_handlers, handler_info);
 	handler_info->priority = priority;
-	handler_info->event = event;
+	handler_info->event = event_info;
 	handler_info->state = handler_state;
+	handler_info->group = GROUP_DEFAULT;
+	handler_info->removed = FALSE;
 	handler_info->handler = handler;
 	handler_info->user_data = user_data;
+	histogram_reset(&handler_info->stats);
 
-	// Insert the handler into the list.
-	event->l_event_handlers = list_insert_sorted(event->l_event_handlers, handler_info, _event_insert_handler);
+	// Insert the handler into the array.
+	_event_insert_handler(handler_info);
+	handlers_version++;
 
 	// Return the generated ID.
 	return handler_info->id;
@@ -268,8 +481,30 @@ void event_handler_set_state(int id, EventHandlerState handler_state)
 
 	handler = _event_get_handler(id);
 
-	if (handler)
+	if (handler && handler->state != handler_state) {
 		handler->state = handler_state;
+		handlers_version++;
+	}
+}
+
+/**
+ *  Moves a specified event handler into a group. The event handler is only called
+ *  while its group is active (see group_set_state()). This function doesn't do
+ *  anything, if no event handler with the specified id exists.
+ *
+ *  @param id					id of the event handler
+ *  @param group				id of the group as returned by group_register()
+ */
+void event_handler_set_group(int id, int group)
+{
+	EventHandlerInfo *handler;
+
+	handler = _event_get_handler(id);
+
+	if (handler && handler->group != group) {
+		handler->group = group;
+		handlers_version++;
+	}
 }
 
 /**
@@ -299,25 +534,35 @@ void event_handler_set_user_data(int id, void *user_data)
  */
 void event_disconnect(int id)
 {
-	List *link;
 	EventHandlerInfo *handler;
 	EventInfo *event;
+	int i;
 
-	// Get the link of the list representing the appropriate handler.
-	// If we couldn't find it, we can return.
-	link = _event_get_handler_link(id);
-	if (!link)
+	// Get the appropriate handler. If we couldn't find it, we can return.
+	handler = _event_get_handler(id);
+	if (!handler)
 		return;
 
-	// If we have the link, we can gather the other interesting data.
-	handler = (EventHandlerInfo *)link->data;
-	event = handler->event;
-
-	// Remove the link from the list of event handlers and free the data.
-	// Even if the new list contains no handlers, we are going to keep
+	// Remove the handler from the array of its event and free it.
+	// Even if the event has no handlers anymore, we are going to keep
 	// the EventInfo, maybe someone wants to connect again later.
-	event->l_event_handlers = list_delete_link(event->l_event_handlers, link);
-	free(handler);
+	event = handler->event;
+	i = _event_get_handler_index(handler);
+	memmove(&event->handlers[i], &event->handlers[i + 1], (event->n_handlers - i - 1) * sizeof(EventHandlerInfo *));
+	event->n_handlers--;
+
+	// Release the id, so that it is detected as stale from now on.
+	slotmap_remove(m_handlers, id);
+	handlers_version++;
+
+	// If the event is being raised right now, the handler is still referenced
+	// by the cached array. It is freed as soon as all events have been raised.
+	if (event->dispatching) {
+		handler->removed = TRUE;
+		l_removed = list_prepend(l_removed, handler);
+	} else {
+		_event_free_handler(handler);
+	}
 }
 
 /**
@@ -325,6 +570,10 @@ void event_disconnect(int id)
  *  to this event and which is enabled will be called passing the
  *  given event_data to it.
  *
+ *  This is a convenience wrapper around event_raise_id() which has to look up the
+ *  event by its name first. Events which are raised often should be raised by
+ *  their id instead.
+ *
  *  @note This function is blocking until all event handlers are called.
  *
  *  @param name				name of the event
@@ -332,47 +581,291 @@ void event_disconnect(int id)
  */
 void event_raise(char *name, void *event_data)
 {
-	List *event_link;
-	List *prev_event_link;
-	List *handler_link;
+	int event;
 
-	EventInfo *event;
-	EventInfo *prev_event;
+	// First we have to get the event, if we don't find it, we can return.
+	event = _event_find_event(name);
+	if (event)
+		event_raise_id(event, event_data);
+}
+
+/**
+ *  Raises an event specified by its id. Every event handler which is connected
+ *  to this event, which is enabled and whose group is active will be called passing
+ *  the given event_data to it.
+ *
+ *  The active event handlers are cached per event, so inactive handlers and groups
+ *  cost nothing here. Event handlers which are connected while the event is raised
+ *  are called the next time the event is raised. Event handlers which are disabled or
+ *  disconnected while the event is raised aren't called anymore.
+ *
+ *  @note This function is blocking until all event handlers are called.
+ *
+ *  @param event			id of the event as returned by event_register()
+ *  @param event_data		data which will be passed to the event handler functions
+ */
+void event_raise_id(int event, void *event_data)
+{
+	EventInfo *event_info;
 	EventHandlerInfo *handler;
+	unsigned int version, group_version;
+	bool stale;
+	Uint64 start;
+	int i;
+
+	// Get the event, if the id is invalid, we can return.
+	event_info = _event_get_event(event);
+	if (!event_info)
+		return;
+
+	// Bring the cached array up to date. This isn't possible if the event is
+	// raised by one of its own handlers, as the outer call is still using it.
+	stale = _event_is_stale(event_info);
+	if (stale && !event_info->dispatching) {
+		_event_rebuild_active(event_info);
+		stale = FALSE;
+	}
+
+	version = handlers_version;
+	group_version = group_get_version();
+
+	event_info->dispatching++;
+	dispatch_depth++;
+
+	// Now iterate through the active event handlers. As long as no handler changes
+	// anything, the handlers don't have to be checked one by one.
+	for (i = 0; i < event_info->n_active; i++) {
+		handler = event_info->active[i];
+
+		if ((stale || version != handlers_version || group_version != group_get_version())
+				&& !_event_handler_is_active(handler))
+			continue;
+
+		// Call the event handler function with the appropriate
+		// arguments and measure how long it takes.
+		start = time_get_ns();
+		handler->handler(event_data, handler->user_data);
+		histogram_add(&handler->stats, time_get_ns() - start);
+	}
+
+	event_info->dispatching--;
+	dispatch_depth--;
+
+	// Free the handlers which have been disconnected in the meantime
+	if (!dispatch_depth && l_removed) {
+		list_free_full(l_removed, _event_free_handler);
+		l_removed = NULL;
+	}
+
+	// Increase the counter
+	event_info->raise_count++;
+}
+
+/**
+ *  Posts an event. In contrast to event_raise() the event handlers aren't called
+ *  immediately. A copy of the event data is appended to a queue and the event is
+ *  raised the next time event_dispatch_posted() is called.
+ *
+ *  This is a convenience wrapper around event_post_id().
+ *
+ *  @param name				name of the event
+ *  @param event_data		data which will be copied and passed to the event handler functions (may be NULL)
+ *  @param size				size of the event data in bytes
+ */
+void event_post(char *name, void *event_data, int size)
+{
+	int event;
 
 	// First we have to get the event, if we don't find it, we can return.
-	event_link = _event_get_event_link(name);
-	if (!event_link)
+	event = _event_find_event(name);
+	if (event)
+		event_post_id(event, event_data, size);
+}
+
+/**
+ *  Posts an event specified by its id. In contrast to event_raise_id() the event
+ *  handlers aren't called immediately. A copy of the event data is appended to a queue
+ *  and the event is raised the next time event_dispatch_posted() is called.
+ *
+ *  Because the event handlers are called later, it is safe to post events while
+ *  iterating over objects which the event handlers might free.
+ *
+ *  @param event			id of the event as returned by event_register()
+ *  @param event_data		data which will be copied and passed to the event handler functions (may be NULL)
+ *  @param size				size of the event data in bytes
+ */
+void event_post_id(int event, void *event_data, int size)
+{
+	EventQueue *queue = &a_queues[queue_post];
+	EventQueueEntry *entry;
+	int entry_size;
+
+	if (!_event_get_event(event))
 		return;
-	event = (EventInfo *)event_link->data;
 
-	// Now iterate through every event handler
-	handler_link = list_first(event->l_event_handlers);
-	while (handler_link) {
-		handler = (EventHandlerInfo *)handler_link->data;
+	// Calculate the space needed, keeping the next entry aligned
+	entry_size = sizeof(EventQueueEntry) + size;
+	entry_size = (entry_size + EVENT_QUEUE_ALIGN - 1) & ~(EVENT_QUEUE_ALIGN - 1);
 
-		// If the handler is enabled, call the event handler function with
-		// the appropriate arguments.
-		if (handler->state == EVENT_HANDLER_ENABLED) {
-			handler->handler(event_data, handler->user_data);
+	// Grow the queue if it is full. This should only happen if a lot of events
+	// are posted in a single main loop iteration.
+	if (queue->length + entry_size > queue->size) {
+		while (queue->length + entry_size > queue->size)
+			queue->size *= 2;
+		queue->buffer = (char *)realloc(queue->buffer, queue->size);
+	}
+
+	// Append the entry and copy the payload
+	entry = (EventQueueEntry *)(queue->buffer + queue->length);
+	entry->event = event;
+	entry->size = size;
+	if (size > 0)
+		memcpy(entry + 1, event_data, size);
+
+	queue->length += entry_size;
+}
+
+/**
+ *  Raises all posted events in the order they were posted. Events posted by event
+ *  handlers during the dispatch are dispatched too, before this function returns.
+ *
+ *  @note This function should be called at a defined point of the main loop.
+ *
+ *  @returns		the number of events which have been dispatched
+ */
+int event_dispatch_posted()
+{
+	EventQueue *queue;
+	EventQueueEntry *entry;
+	int offset, entry_size;
+	int count = 0;
+
+	while (a_queues[queue_post].length > 0) {
+		// Swap the queues, so that events posted from now on are collected
+		// in the other queue while we are dispatching this one.
+		queue = &a_queues[queue_post];
+		queue_post = !queue_post;
+
+		// Raise each event with the copy of its payload
+		offset = 0;
+		while (offset < queue->length) {
+			entry = (EventQueueEntry *)(queue->buffer + offset);
+
+			event_raise_id(entry->event, (entry->size > 0) ? (void *)(entry + 1) : NULL);
+			count++;
+
+			entry_size = sizeof(EventQueueEntry) + entry->size;
+			offset += (entry_size + EVENT_QUEUE_ALIGN - 1) & ~(EVENT_QUEUE_ALIGN - 1);
 		}
 
-		handler_link = list_next(handler_link);
+		queue->length = 0;
 	}
 
-	// Increase the counter
-	event->raise_count++;
-
-	// Check whether the event before this one in the event list has a smaller raise_count.
-	// If yes, exchange the positions. This way the list will always be sorted, so that
-	// often raised event are found quicker in the list.
-	prev_event_link = list_prev(event_link);
-	if (prev_event_link) {
-		prev_event = (EventInfo *)list_prev(event_link)->data;
-
-		if (prev_event->raise_count < event->raise_count) {
-			prev_event_link->data = event;
-			event_link->data = prev_event;
+	return count;
+}
+
+/**
+ *  Posts an event from any thread. The event is raised in the main thread the next time
+ *  event_dispatch_async() is called. The main loop does this in every iteration, so the
+ *  event is raised at the latest when its current sleep is over.
+ *
+ *  The queue is bounded and never blocks. If it is full, the event is dropped and counted
+ *  (see event_get_async_overflow_count()).
+ *
+ *  @note	This function is thread-safe. The event must have been registered before.
+ *
+ *  @param event			id of the event as returned by event_register()
+ *  @param event_data		data which will be passed to the event handler functions as it is (it isn't copied)
+ *
+ *  @returns				TRUE, if the event has been queued. FALSE, if it has been dropped.
+ */
+bool event_post_async(int event, void *event_data)
+{
+	return mpsc_push(q_async, event, event_data);
+}
+
+/**
+ *  Raises all events which have been posted from other threads by event_post_async().
+ *
+ *  @attention	This function must only be called by the main thread!
+ *
+ *  @returns		the number of events which have been dispatched
+ */
+int event_dispatch_async()
+{
+	void *event_data;
+	int event;
+	int count = 0;
+
+	while (mpsc_pop(q_async, &event, &event_data)) {
+		event_raise_id(event, event_data);
+		count++;
+	}
+
+	return count;
+}
+
+/**
+ *  Gets the number of events posted by event_post_async() which have been dropped
+ *  because the queue was full.
+ *
+ *  @returns		the number of dropped events
+ */
+unsigned int event_get_async_overflow_count()
+{
+	return mpsc_get_overflow_count(q_async);
+}
+
+/**
+ *  Gets the statistics about the time spent in a specified event handler.
+ *  The histogram holds the number of calls, the total and the maximal time
+ *  and the distribution of the durations, all in nanoseconds.
+ *
+ *  @attention	The returned histogram belongs to the event handler, don't modify it!
+ *
+ *  @param id		id of the event handler
+ *
+ *  @returns		the statistics or NULL if no event handler with the specified id exists
+ */
+Histogram * event_handler_get_stats(int id)
+{
+	EventHandlerInfo *handler;
+
+	handler = _event_get_handler(id);
+
+	return (handler) ? &handler->stats : NULL;
+}
+
+/**
+ *  Prints the statistics about the time spent in every event handler to stdout.
+ *  This may be useful to find event handlers which take too long.
+ */
+void event_print_stats()
+{
+	EventInfo *event_info;
+	EventHandlerInfo *handler_info;
+	int i, j;
+
+	printf("async queue overflows: %u\n", event_get_async_overflow_count());
+
+	// Loop trough all events
+	for (i = 0; i < n_events; i++) {
+		event_info = a_events[i];
+
+		printf("%s (raise count: %lu)\n", event_info->name, event_info->raise_count);
+
+		// Loop trough all handlers which have been called
+		for (j = 0; j < event_info->n_handlers; j++) {
+			handler_info = event_info->handlers[j];
+
+			if (handler_info->stats.count == 0)
+				continue;
+
+			printf("-> id: %6d  handler: %p  total: %9.3fms\n   ",
+					handler_info->id,
+					handler_info->handler,
+					handler_info->stats.sum / 1000000.0);
+			histogram_print(&handler_info->stats);
 		}
 	}
 }
@@ -383,33 +876,27 @@ void event_raise(char *name, void *event_data)
  */
 void event_print_structure()
 {
-	List *event_link, *handler_link;
-
 	EventInfo *event_info;
 	EventHandlerInfo *handler_info;
+	int i, j;
 
 	// Loop trough all events
-	event_link = list_first(l_events);
-	while (event_link) {
-		event_info = (EventInfo *)event_link->data;
+	for (i = 0; i < n_events; i++) {
+		event_info = a_events[i];
 
-		printf("%s (raise count: %lu)\n", event_info->name, event_info->raise_count);
+		printf("%s (id: %d  raise count: %lu)\n", event_info->name, event_info->id, event_info->raise_count);
 
 		// Loop trough all handlers
-		handler_link = list_first(event_info->l_event_handlers);
-		while (handler_link) {
-			handler_info = (EventHandlerInfo *)handler_link->data;
+		for (j = 0; j < event_info->n_handlers; j++) {
+			handler_info = event_info->handlers[j];
 
-			printf("-> id: %3d  priority: %2d  state: %1d  handler: 0x%p\n",
+			printf("-> id: %3d  priority: %2d  state: %1d  group: %2d  handler: 0x%p\n",
 					handler_info->id,
 					handler_info->priority,
 					handler_info->state,
+					handler_info->group,
 					handler_info->handler);
-
-			handler_link = list_next(handler_link);
 		}
-
-		event_link = list_next(event_link);
 	}
 }
 
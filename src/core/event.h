@@ -28,12 +28,33 @@
  *  An event is specified by any name. If someone uses the event_raise() function
  *  every event handler connected to the given event is called synchronously.
  *
+ *  Every event gets an integer id when it is registered for the first time
+ *  (see event_register()). Modules which raise an event often should keep this
+ *  id and use event_raise_id() which doesn't have to look up the event by its name.
+ *
+ *  Events can also be posted by using the event_post() function. A posted event is
+ *  stored in a queue together with a copy of its data and the event handlers are called
+ *  when the main loop dispatches the queue by calling event_dispatch_posted().
+ *
+ *  Other threads must not raise events. They can use event_post_async() instead, which
+ *  passes the event through a lock-free queue to the main thread.
+ *
+ *  Every event handler belongs to a group (see the group module). Event handlers of
+ *  inactive groups aren't called, so a whole set of event handlers can be disabled
+ *  at once, for example when the scene changes.
+ *
+ *  The time spent in every event handler is measured. The statistics can be queried
+ *  by event_handler_get_stats() or printed by event_print_stats().
+ *
  *  @{
  */
 
 #ifndef EVENT_H_
 #define EVENT_H_
 
+#include "common.h"
+#include "histogram.h"
+
 /**
  *  Prototype for an event handler function.
  *
@@ -53,11 +74,23 @@ typedef enum {
 extern void event_init();
 extern void event_destroy();
 
+extern int event_register(char *name);
 extern int event_connect(char *name, int priority, EventHandler handler, void *user_data, EventHandlerState handler_state);
+extern int event_connect_id(int event, int priority, EventHandler handler, void *user_data, EventHandlerState handler_state);
 extern void event_handler_set_state(int id, EventHandlerState handler_state);
+extern void event_handler_set_group(int id, int group);
 extern void event_handler_set_user_data(int id, void *user_data);
 extern void event_disconnect(int id);
 extern void event_raise(char *name, void *event_data);
+extern void event_raise_id(int event, void *event_data);
+extern void event_post(char *name, void *event_data, int size);
+extern void event_post_id(int event, void *event_data, int size);
+extern int event_dispatch_posted();
+extern bool event_post_async(int event, void *event_data);
+extern int event_dispatch_async();
+extern unsigned int event_get_async_overflow_count();
+extern Histogram * event_handler_get_stats(int id);
+extern void event_print_stats();
 extern void event_print_structure();
 
 #endif /* event_H_ */
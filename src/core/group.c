@@ -0,0 +1,193 @@
+/*
+ * group.c
+ * This file is part of Arena1
+ *
+ * Copyright (C) 2013
+ *
+ * Arena1 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Arena1 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Arena1. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ *  @addtogroup group
+ *  @{
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "hashmap.h"
+#include "scene.h"
+#include "group.h"
+
+
+
+#define GROUP_NAME_MAX_LENGTH		32		/**< the maximum length of a group name (including null-terminator) */
+
+/**
+ *  A struct which holds several informations about a group.
+ *
+ *  @private
+ */
+typedef struct {
+	char		name[GROUP_NAME_MAX_LENGTH];	/**< name of the group */
+	int			scene;							/**< id of the scene the group is bound to or 0 */
+} GroupInfo;
+
+static GroupInfo	 a_groups[GROUP_MAX];		/**< array of all existing groups, indexed by their id */
+static int			 n_groups = 0;				/**< number of existing groups */
+static HashMap		*m_groups = NULL;			/**< map which holds all existing groups by their name */
+static Uint32		 active_mask = 0;			/**< one bit for each group, set if the group is active */
+static unsigned int	 version = 0;				/**< incremented whenever a group is enabled or disabled */
+
+/**
+ *  Initializes this module.
+ */
+void group_init()
+{
+	m_groups = hashmap_new_str();
+
+	// Create the default group
+	strcpy(a_groups[GROUP_DEFAULT].name, "default");
+	a_groups[GROUP_DEFAULT].scene = 0;
+	n_groups = 1;
+	hashmap_insert_str(m_groups, a_groups[GROUP_DEFAULT].name, &a_groups[GROUP_DEFAULT]);
+
+	active_mask = 1 << GROUP_DEFAULT;
+	version++;
+}
+
+/**
+ *  Destroys this module freeing any allocated data.
+ */
+void group_destroy()
+{
+	hashmap_free(m_groups);
+	m_groups = NULL;
+
+	n_groups = 0;
+	active_mask = 0;
+}
+
+/**
+ *  Registers a group and returns its id. If the group already exists, the id
+ *  of the existing group is returned. A new group is active.
+ *
+ *  @param name		name of the group
+ *
+ *  @returns		the id of the group or the id of the default group if there are too many groups
+ */
+int group_register(char *name)
+{
+	GroupInfo *group;
+
+	// Does the group already exist?
+	group = (GroupInfo *)hashmap_lookup_str(m_groups, name);
+	if (group)
+		return group - a_groups;
+
+	// Check whether there is space left for a new group
+	if (n_groups == GROUP_MAX || strlen(name) > GROUP_NAME_MAX_LENGTH - 1) {
+		fprintf(stderr, "warning: couldn't register group %s\n", name);
+		return GROUP_DEFAULT;
+	}
+
+	strcpy(a_groups[n_groups].name, name);
+	a_groups[n_groups].scene = 0;
+	hashmap_insert_str(m_groups, a_groups[n_groups].name, &a_groups[n_groups]);
+	group_set_state(n_groups, TRUE);
+
+	return n_groups++;
+}
+
+/**
+ *  Activates or deactivates a group and thus all of its event handlers and timers.
+ *  The default group can't be deactivated.
+ *
+ *  @param group	id of the group
+ *  @param active	whether the group shall be active
+ */
+void group_set_state(int group, bool active)
+{
+	Uint32 mask;
+
+	if (group <= GROUP_DEFAULT || group >= GROUP_MAX)
+		return;
+
+	mask = (active) ? active_mask | (1 << group) : active_mask & ~(1 << group);
+	if (mask != active_mask) {
+		active_mask = mask;
+		version++;
+	}
+}
+
+/**
+ *  Binds a group to a scene. From now on the group is active exactly while
+ *  the scene is the active one.
+ *
+ *  @param group	id of the group
+ *  @param scene	id of the scene as returned by scene_register() or 0 to unbind the group
+ */
+void group_bind_scene(int group, int scene)
+{
+	if (group <= GROUP_DEFAULT || group >= n_groups)
+		return;
+
+	a_groups[group].scene = scene;
+
+	if (scene)
+		group_set_state(group, scene_check_id(scene));
+}
+
+/**
+ *  Activates the groups which are bound to a scene and deactivates the groups
+ *  which are bound to any other scene. This is called by the scene module whenever
+ *  the active scene changes.
+ *
+ *  @param scene	id of the scene which is active now
+ */
+void group_apply_scene(int scene)
+{
+	int i;
+
+	for (i = GROUP_DEFAULT + 1; i < n_groups; i++) {
+		if (a_groups[i].scene)
+			group_set_state(i, a_groups[i].scene == scene);
+	}
+}
+
+/**
+ *  Checks whether a group is active.
+ *
+ *  @param group	id of the group
+ *
+ *  @returns		TRUE, if the group is active
+ */
+bool group_is_active(int group)
+{
+	return (active_mask >> group) & 1;
+}
+
+/**
+ *  Gets a number which changes whenever a group is activated or deactivated.
+ *  This may be used to find out whether cached information about active
+ *  groups is still up to date.
+ *
+ *  @returns		the current version
+ */
+unsigned int group_get_version()
+{
+	return version;
+}
+
+/** @} */
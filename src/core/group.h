@@ -0,0 +1,59 @@
+/*
+ * group.h
+ * This file is part of Arena1
+ *
+ * Copyright (C) 2013
+ *
+ * Arena1 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Arena1 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Arena1. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ *  @defgroup group group
+ *  @brief Provides groups to enable or disable many event handlers and timers at once.
+ *
+ *  This module manages groups of event handlers and timers. Every event handler
+ *  and every timer belongs to exactly one group (by default the group 0, which is
+ *  always active). An event handler is only called and a timer only fires if it is
+ *  enabled on its own and if its group is active.
+ *
+ *  A group can be bound to a scene. Such a group is active exactly while its scene is
+ *  the active one, so a change of the scene enables or disables all event handlers and
+ *  timers of the group at once, without touching each of them.
+ *
+ *  @{
+ */
+
+#ifndef GROUP_H_
+#define GROUP_H_
+
+#include "common.h"
+
+#define GROUP_MAX				32		/**< maximum number of groups (including the default group) */
+#define GROUP_DEFAULT			0		/**< id of the default group, which is always active */
+
+extern void group_init();
+extern void group_destroy();
+
+extern int group_register(char *name);
+extern void group_set_state(int group, bool active);
+extern void group_bind_scene(int group, int scene);
+extern void group_apply_scene(int scene);
+
+extern bool group_is_active(int group);
+extern unsigned int group_get_version();
+
+#endif /* GROUP_H_ */
+
+/** @} */
@@ -0,0 +1,369 @@
+/*
+ * hashmap.c
+ * This file is part of Arena1
+ *
+ * Copyright (C) 2013
+ *
+ * Arena1 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Arena1 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Arena1. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ *  @addtogroup hashmap
+ *  @{
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "hashmap.h"
+
+
+
+#define HASHMAP_INITIAL_SIZE	16		/**< number of elements allocated by a new hash map */
+#define HASHMAP_EMPTY			0		/**< hash value of an empty element */
+#define HASHMAP_REMOVED			1		/**< hash value of a removed element */
+
+// --- Static Functions -------------------------------------------------------
+
+/**
+ *  Calculates the hash of a string (FNV-1a).
+ *
+ *  @param key		a string
+ *
+ *  @returns		the hash, which is never HASHMAP_EMPTY or HASHMAP_REMOVED
+ */
+static unsigned int _hashmap_hash_str(const char *key)
+{
+	unsigned int hash = 2166136261u;
+
+	while (*key) {
+		hash ^= (unsigned char)*key++;
+		hash *= 16777619u;
+	}
+
+	return (hash < 2) ? hash + 2 : hash;
+}
+
+/**
+ *  Calculates the hash of an integer (Fibonacci hashing).
+ *
+ *  @param key		an integer
+ *
+ *  @returns		the hash, which is never HASHMAP_EMPTY or HASHMAP_REMOVED
+ */
+static unsigned int _hashmap_hash_int(intptr_t key)
+{
+	unsigned int hash = (unsigned int)((uint64_t)key * 0x9E3779B97F4A7C15ull >> 32);
+
+	return (hash < 2) ? hash + 2 : hash;
+}
+
+/**
+ *  Creates a new, empty hash map.
+ *
+ *  @param string_keys	whether the keys are strings or integers
+ *
+ *  @returns			the new hash map
+ */
+static HashMap * _hashmap_new(int string_keys)
+{
+	HashMap *map = (HashMap *)malloc(sizeof(HashMap));
+
+	map->size = HASHMAP_INITIAL_SIZE;
+	map->entries = (HashMapEntry *)calloc(map->size, sizeof(HashMapEntry));
+	map->count = map->used = 0;
+	map->string_keys = string_keys;
+
+	return map;
+}
+
+/**
+ *  Searches the element with a specified key.
+ *
+ *  @param map		a hash map
+ *  @param hash		hash of the key
+ *  @param str		the key, if the map has string keys
+ *  @param num		the key, if the map has integer keys
+ *
+ *  @returns		the index of the element or -1 if the key couldn't be found
+ */
+static int _hashmap_find(HashMap *map, unsigned int hash, const char *str, intptr_t num)
+{
+	unsigned int mask = map->size - 1;
+	unsigned int i = hash & mask;
+	HashMapEntry *entry;
+
+	// Removed elements don't stop the search, only empty elements do.
+	// There is always an empty element, because the map is never full.
+	while ((entry = &map->entries[i])->hash != HASHMAP_EMPTY) {
+		if (entry->hash == hash) {
+			if (map->string_keys ? strcmp(entry->key.str, str) == 0 : entry->key.num == num)
+				return i;
+		}
+
+		i = (i + 1) & mask;
+	}
+
+	return -1;
+}
+
+/**
+ *  Stores an element without checking whether the key already exists.
+ *
+ *  @param map		a hash map
+ *  @param hash		hash of the key
+ *  @param str		the key, if the map has string keys
+ *  @param num		the key, if the map has integer keys
+ *  @param value	the value
+ */
+static void _hashmap_put(HashMap *map, unsigned int hash, const char *str, intptr_t num, void *value)
+{
+	unsigned int mask = map->size - 1;
+	unsigned int i = hash & mask;
+	HashMapEntry *entry;
+
+	// Take the first element which is empty or has been removed
+	while ((entry = &map->entries[i])->hash > HASHMAP_REMOVED)
+		i = (i + 1) & mask;
+
+	if (entry->hash == HASHMAP_EMPTY)
+		map->used++;
+
+	entry->hash = hash;
+	if (map->string_keys)
+		entry->key.str = str;
+	else
+		entry->key.num = num;
+	entry->value = value;
+
+	map->count++;
+}
+
+/**
+ *  Reallocates the array of elements and stores all elements again. Removed
+ *  elements are dropped this way.
+ *
+ *  @param map		a hash map
+ *  @param size		the new number of elements, a power of two
+ */
+static void _hashmap_resize(HashMap *map, int size)
+{
+	HashMapEntry *entries = map->entries;
+	int old_size = map->size;
+	int i;
+
+	map->size = size;
+	map->entries = (HashMapEntry *)calloc(size, sizeof(HashMapEntry));
+	map->count = map->used = 0;
+
+	for (i = 0; i < old_size; i++) {
+		if (entries[i].hash > HASHMAP_REMOVED)
+			_hashmap_put(map, entries[i].hash, entries[i].key.str, entries[i].key.num, entries[i].value);
+	}
+
+	free(entries);
+}
+
+/**
+ *  Inserts or replaces an element.
+ *
+ *  @param map		a hash map
+ *  @param hash		hash of the key
+ *  @param str		the key, if the map has string keys
+ *  @param num		the key, if the map has integer keys
+ *  @param value	the value
+ */
+static void _hashmap_insert(HashMap *map, unsigned int hash, const char *str, intptr_t num, void *value)
+{
+	int i;
+
+	// Replace the value if the key already exists
+	i = _hashmap_find(map, hash, str, num);
+	if (i >= 0) {
+		map->entries[i].value = value;
+		return;
+	}
+
+	// Keep the map filled to at most three quarters. If this is mostly because of
+	// removed elements, the array is only cleaned up instead of being doubled.
+	if ((map->used + 1) * 4 > map->size * 3)
+		_hashmap_resize(map, ((map->count + 1) * 2 > map->size) ? map->size * 2 : map->size);
+
+	_hashmap_put(map, hash, str, num, value);
+}
+
+/**
+ *  Removes an element.
+ *
+ *  @param map		a hash map
+ *  @param hash		hash of the key
+ *  @param str		the key, if the map has string keys
+ *  @param num		the key, if the map has integer keys
+ *
+ *  @returns		the value of the removed element or NULL if the key couldn't be found
+ */
+static void * _hashmap_remove(HashMap *map, unsigned int hash, const char *str, intptr_t num)
+{
+	int i;
+
+	i = _hashmap_find(map, hash, str, num);
+	if (i < 0)
+		return NULL;
+
+	// Mark the element as removed, so that the search for other keys doesn't stop here
+	map->entries[i].hash = HASHMAP_REMOVED;
+	map->count--;
+
+	return map->entries[i].value;
+}
+
+// --- Public Functions -------------------------------------------------------
+
+/**
+ *  Creates a new, empty hash map with string keys.
+ *
+ *  @returns		the new hash map
+ */
+HashMap * hashmap_new_str()
+{
+	return _hashmap_new(1);
+}
+
+/**
+ *  Creates a new, empty hash map with integer keys.
+ *
+ *  @returns		the new hash map
+ */
+HashMap * hashmap_new_int()
+{
+	return _hashmap_new(0);
+}
+
+/**
+ *  Frees a hash map. The values and the keys aren't freed.
+ *
+ *  @param map		a hash map
+ */
+void hashmap_free(HashMap *map)
+{
+	if (!map)
+		return;
+
+	free(map->entries);
+	free(map);
+}
+
+/**
+ *  Inserts a value into a hash map with string keys. If the key
+ *  already exists, its value is replaced.
+ *
+ *  @attention	The key isn't copied, it must stay valid as long as it is in the map!
+ *
+ *  @param map		a hash map with string keys
+ *  @param key		the key
+ *  @param value	the value, which mustn't be NULL
+ */
+void hashmap_insert_str(HashMap *map, const char *key, void *value)
+{
+	_hashmap_insert(map, _hashmap_hash_str(key), key, 0, value);
+}
+
+/**
+ *  Looks up a value in a hash map with string keys.
+ *
+ *  @param map		a hash map with string keys
+ *  @param key		the key
+ *
+ *  @returns		the value or NULL if the key couldn't be found
+ */
+void * hashmap_lookup_str(HashMap *map, const char *key)
+{
+	int i = _hashmap_find(map, _hashmap_hash_str(key), key, 0);
+
+	return (i >= 0) ? map->entries[i].value : NULL;
+}
+
+/**
+ *  Removes a value from a hash map with string keys.
+ *
+ *  @param map		a hash map with string keys
+ *  @param key		the key
+ *
+ *  @returns		the removed value or NULL if the key couldn't be found
+ */
+void * hashmap_remove_str(HashMap *map, const char *key)
+{
+	return _hashmap_remove(map, _hashmap_hash_str(key), key, 0);
+}
+
+/**
+ *  Inserts a value into a hash map with integer keys. If the key
+ *  already exists, its value is replaced.
+ *
+ *  @param map		a hash map with integer keys
+ *  @param key		the key
+ *  @param value	the value, which mustn't be NULL
+ */
+void hashmap_insert_int(HashMap *map, intptr_t key, void *value)
+{
+	_hashmap_insert(map, _hashmap_hash_int(key), NULL, key, value);
+}
+
+/**
+ *  Looks up a value in a hash map with integer keys.
+ *
+ *  @param map		a hash map with integer keys
+ *  @param key		the key
+ *
+ *  @returns		the value or NULL if the key couldn't be found
+ */
+void * hashmap_lookup_int(HashMap *map, intptr_t key)
+{
+	int i = _hashmap_find(map, _hashmap_hash_int(key), NULL, key);
+
+	return (i >= 0) ? map->entries[i].value : NULL;
+}
+
+/**
+ *  Removes a value from a hash map with integer keys.
+ *
+ *  @param map		a hash map with integer keys
+ *  @param key		the key
+ *
+ *  @returns		the removed value or NULL if the key couldn't be found
+ */
+void * hashmap_remove_int(HashMap *map, intptr_t key)
+{
+	return _hashmap_remove(map, _hashmap_hash_int(key), NULL, key);
+}
+
+/**
+ *  Calls a function for every value in a hash map. The order is undefined.
+ *
+ *  @attention	The function must not insert into or remove from the map!
+ *
+ *  @param map		a hash map
+ *  @param func		the function to call for every value
+ */
+void hashmap_foreach(HashMap *map, void (*func)(void *value))
+{
+	int i;
+
+	for (i = 0; i < map->size; i++) {
+		if (map->entries[i].hash > HASHMAP_REMOVED)
+			func(map->entries[i].value);
+	}
+}
+
+/** @} */
@@ -0,0 +1,100 @@
+/*
+ * hashmap.h
+ * This file is part of Arena1
+ *
+ * Copyright (C) 2013
+ *
+ * Arena1 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Arena1 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Arena1. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ *  @defgroup hashmap hashmap
+ *  @brief Provides a hash map with string or integer keys.
+ *
+ *  This module provides a hash map which maps either strings or integers to
+ *  pointers to arbitrary data. Inserting, looking up and removing an element
+ *  takes constant time on average.
+ *
+ *  The elements are stored in a single array using open addressing with linear
+ *  probing, so there is no allocation per element and a lookup usually touches a
+ *  single cache line. The hash of every key is stored next to it, so keys are only
+ *  compared if their hashes are equal. The array is doubled if it is filled to
+ *  three quarters.
+ *
+ *  @attention	String keys aren't copied! The string must not be modified or freed
+ *  			as long as it is used as a key in the map.
+ *
+ *  @note	NULL can't be stored as a value, because the lookup functions return
+ *  		NULL if a key can't be found.
+ *
+ *  @{
+ */
+
+#ifndef HASHMAP_H_
+#define HASHMAP_H_
+
+#include <stdint.h>
+
+/**
+ *  An element of a hash map.
+ *
+ *  @private
+ */
+typedef struct {
+	unsigned int	 hash;		/**< hash of the key, 0 if the element is empty and 1 if it has been removed */
+	union {
+		const char	*str;		/**< the key of a map with string keys */
+		intptr_t	 num;		/**< the key of a map with integer keys */
+	} key;
+	void			*value;		/**< the value */
+} HashMapEntry;
+
+/**
+ *  The HashMap struct holds the array of elements.
+ */
+typedef struct {
+	HashMapEntry	*entries;		/**< array of elements */
+	int				 size;			/**< number of allocated elements, always a power of two */
+	int				 count;			/**< number of elements holding a value */
+	int				 used;			/**< number of elements holding a value or marked as removed */
+	int				 string_keys;	/**< whether the keys are strings or integers */
+} HashMap;
+
+extern HashMap * hashmap_new_str();
+extern HashMap * hashmap_new_int();
+extern void hashmap_free(HashMap *map);
+
+extern void hashmap_insert_str(HashMap *map, const char *key, void *value);
+extern void * hashmap_lookup_str(HashMap *map, const char *key);
+extern void * hashmap_remove_str(HashMap *map, const char *key);
+
+extern void hashmap_insert_int(HashMap *map, intptr_t key, void *value);
+extern void * hashmap_lookup_int(HashMap *map, intptr_t key);
+extern void * hashmap_remove_int(HashMap *map, intptr_t key);
+
+extern void hashmap_foreach(HashMap *map, void (*func)(void *value));
+
+/**
+ *  A convenience macro to get the number of elements stored in a hash map.
+ *
+ *  @param map		a hash map
+ *
+ *  @returns		the number of elements
+ */
+#define hashmap_count(map)		((map)->count)
+
+#endif /* HASHMAP_H_ */
+
+/** @} */
@@ -0,0 +1,205 @@
+/*
+ * histogram.c
+ * This file is part of Arena1
+ *
+ * Copyright (C) 2013
+ *
+ * Arena1 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Arena1 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Arena1. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ *  @addtogroup histogram
+ *  @{
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "histogram.h"
+
+
+#define SUB_BUCKETS		(1 << HISTOGRAM_SUB_BITS)		/**< number of buckets per power of two */
+
+// --- Private ---
+
+/**
+ *  Gets the index of the bucket a value belongs to.
+ *
+ *  @param value	a value
+ *
+ *  @returns		index of the bucket
+ */
+static int _histogram_get_index(Uint64 value)
+{
+	int msb, index;
+
+	// Small values have a bucket on their own
+	if (value < SUB_BUCKETS)
+		return (int)value;
+
+	// Otherwise the bucket is given by the most significant bit and the bits following it
+	msb = 63 - __builtin_clzll(value);
+	index = ((msb - HISTOGRAM_SUB_BITS + 1) << HISTOGRAM_SUB_BITS) + (int)((value >> (msb - HISTOGRAM_SUB_BITS)) & (SUB_BUCKETS - 1));
+
+	return (index < HISTOGRAM_BUCKETS) ? index : HISTOGRAM_BUCKETS - 1;
+}
+
+/**
+ *  Gets the biggest value which belongs to a bucket.
+ *
+ *  @param index	index of the bucket
+ *
+ *  @returns		the upper bound of the bucket
+ */
+static Uint64 _histogram_get_upper_bound(int index)
+{
+	int shift;
+
+	if (index < SUB_BUCKETS)
+		return (Uint64)index;
+
+	shift = (index >> HISTOGRAM_SUB_BITS) - 1;
+	return ((Uint64)(SUB_BUCKETS + (index & (SUB_BUCKETS - 1))) << shift) + ((Uint64)1 << shift) - 1;
+}
+
+/**
+ *  Prints a duration given in nanoseconds with a suitable unit.
+ *
+ *  @param ns		a duration in nanoseconds
+ */
+static void _histogram_print_ns(Uint64 ns)
+{
+	if (ns < 10000)
+		printf("%6lluns", (unsigned long long)ns);
+	else if (ns < 10000000)
+		printf("%6.1fus", ns / 1000.0);
+	else
+		printf("%6.1fms", ns / 1000000.0);
+}
+
+// --- Public ---
+
+/**
+ *  Removes all values from a histogram.
+ *
+ *  @param histogram	a histogram
+ */
+void histogram_reset(Histogram *histogram)
+{
+	memset(histogram, 0, sizeof(Histogram));
+}
+
+/**
+ *  Adds a value to a histogram.
+ *
+ *  @param histogram	a histogram
+ *  @param value		the value to add
+ */
+void histogram_add(Histogram *histogram, Uint64 value)
+{
+	if (histogram->count == 0 || value < histogram->min)
+		histogram->min = value;
+	if (value > histogram->max)
+		histogram->max = value;
+
+	histogram->count++;
+	histogram->sum += value;
+	histogram->buckets[_histogram_get_index(value)]++;
+}
+
+/**
+ *  Gets the mean of all values of a histogram.
+ *
+ *  @param histogram	a histogram
+ *
+ *  @returns			the mean or 0 if the histogram is empty
+ */
+Uint64 histogram_get_mean(Histogram *histogram)
+{
+	return (histogram->count) ? histogram->sum / histogram->count : 0;
+}
+
+/**
+ *  Estimates a percentile of the values of a histogram. The returned value is the
+ *  upper bound of the bucket which contains the percentile, but never more than
+ *  the biggest value added.
+ *
+ *  @param histogram	a histogram
+ *  @param percentile	the percentile (e.g. 99.0f)
+ *
+ *  @returns			the estimated percentile or 0 if the histogram is empty
+ */
+Uint64 histogram_get_percentile(Histogram *histogram, float percentile)
+{
+	Uint64 rank, seen = 0;
+	Uint64 bound;
+	int i;
+
+	if (histogram->count == 0)
+		return 0;
+
+	// Get the number of values which are below or equal to the percentile
+	rank = (Uint64)(histogram->count * percentile / 100.0f + 0.5f);
+	if (rank < 1)
+		rank = 1;
+
+	// Find the bucket which contains it
+	for (i = 0; i < HISTOGRAM_BUCKETS; i++) {
+		seen += histogram->buckets[i];
+		if (seen >= rank)
+			break;
+	}
+
+	bound = _histogram_get_upper_bound(i);
+	return (bound < histogram->max) ? bound : histogram->max;
+}
+
+/**
+ *  Prints a summary of a histogram of durations given in nanoseconds to stdout,
+ *  followed by the number of values per power of two.
+ *
+ *  @param histogram	a histogram
+ */
+void histogram_print(Histogram *histogram)
+{
+	Uint32 octave;
+	int i;
+
+	printf("count: %8llu  min:", (unsigned long long)histogram->count);
+	_histogram_print_ns(histogram->min);
+	printf("  mean:");
+	_histogram_print_ns(histogram_get_mean(histogram));
+	printf("  p99:");
+	_histogram_print_ns(histogram_get_percentile(histogram, 99.0f));
+	printf("  max:");
+	_histogram_print_ns(histogram->max);
+	printf("\n");
+
+	if (histogram->count == 0)
+		return;
+
+	// Print the number of values per power of two
+	printf("   ");
+	for (i = 0; i < HISTOGRAM_BUCKETS; i += SUB_BUCKETS) {
+		octave = histogram->buckets[i] + histogram->buckets[i + 1] + histogram->buckets[i + 2] + histogram->buckets[i + 3];
+		if (octave) {
+			printf(" <=");
+			_histogram_print_ns(_histogram_get_upper_bound(i + SUB_BUCKETS - 1));
+			printf(": %u", octave);
+		}
+	}
+	printf("\n");
+}
+
+/** @} */
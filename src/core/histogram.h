@@ -0,0 +1,63 @@
+/*
+ * histogram.h
+ * This file is part of Arena1
+ *
+ * Copyright (C) 2013
+ *
+ * Arena1 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Arena1 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Arena1. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ *  @defgroup histogram histogram
+ *  @brief Provides a histogram with logarithmic buckets for time measurements.
+ *
+ *  This module provides a histogram which is used to collect statistics about
+ *  durations, e.g. how long an event handler takes. Every power of two is split
+ *  into four buckets, so adding a value is cheap and percentiles can be estimated
+ *  with an error of at most 25 percent over a range from nanoseconds to minutes.
+ *
+ *  @{
+ */
+
+#ifndef HISTOGRAM_H_
+#define HISTOGRAM_H_
+
+#include <SDL/SDL.h>
+
+#define HISTOGRAM_SUB_BITS		2										/**< number of bits used to split a power of two into buckets */
+#define HISTOGRAM_BUCKETS		(48 << HISTOGRAM_SUB_BITS)				/**< number of buckets of a histogram */
+
+/**
+ *  The Histogram struct holds the buckets and some summary values.
+ */
+typedef struct {
+	Uint64		count;							/**< number of values added */
+	Uint64		sum;							/**< sum of all values added */
+	Uint64		min;							/**< smallest value added */
+	Uint64		max;							/**< biggest value added */
+	Uint32		buckets[HISTOGRAM_BUCKETS];		/**< number of values per bucket */
+} Histogram;
+
+extern void histogram_reset(Histogram *histogram);
+extern void histogram_add(Histogram *histogram, Uint64 value);
+
+extern Uint64 histogram_get_mean(Histogram *histogram);
+extern Uint64 histogram_get_percentile(Histogram *histogram, float percentile);
+
+extern void histogram_print(Histogram *histogram);
+
+#endif /* HISTOGRAM_H_ */
+
+/** @} */
@@ -0,0 +1,286 @@
+/*
+ * ilist.c
+ * This file is part of Arena1
+ *
+ * Copyright (C) 2013
+ *
+ * Arena1 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Arena1 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Arena1. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ *  @addtogroup ilist
+ *  @{
+ */
+
+#include <stdlib.h>
+#include "ilist.h"
+
+
+
+// --- Private ---
+
+/**
+ *  Unlinks an element from a list and passes it to the release function.
+ *
+ *  @param list		a list
+ *  @param link		the link of the element
+ */
+static void _ilist_unlink(IList *list, ILink *link)
+{
+	if (link->prev)
+		link->prev->next = link->next;
+	else
+		list->head = link->next;
+
+	if (link->next)
+		link->next->prev = link->prev;
+	else
+		list->tail = link->prev;
+
+	link->next = link->prev = NULL;
+
+	if (list->release)
+		list->release(link);
+}
+
+/**
+ *  Skips the elements which aren't visited by a walk, which are the removed
+ *  elements and the elements inserted after the walk has begun.
+ *
+ *  @param iter		state of the walk
+ *  @param link		an element or NULL
+ *
+ *  @returns		the first element at or after link which is visited or NULL
+ */
+static ILink * _ilist_skip(IListIter *iter, ILink *link)
+{
+	while (link && (link->removed || (int)(link->generation - iter->generation) >= 0))
+		link = link->next;
+
+	return link;
+}
+
+/**
+ *  Initializes the members of a link which is inserted into a list.
+ *
+ *  @param list		a list
+ *  @param link		the link of the new element
+ */
+static void _ilist_init_link(IList *list, ILink *link)
+{
+	link->next_removed = NULL;
+	link->generation = list->generation;
+	link->removed = 0;
+	list->length++;
+}
+
+// --- Public ---
+
+/**
+ *  Initializes an empty list.
+ *
+ *  @param list		a list
+ *  @param release	function which is called for every element after it has been unlinked or NULL
+ */
+void ilist_init(IList *list, IListReleaseFunc release)
+{
+	list->head = list->tail = NULL;
+	list->length = 0;
+	list->walking = 0;
+	list->generation = 0;
+	list->removed = NULL;
+	list->release = release;
+}
+
+/**
+ *  Adds an element on to the end of a list.
+ *
+ *  @param list		a list
+ *  @param link		the link of the element, which mustn't be in any list
+ */
+void ilist_append(IList *list, ILink *link)
+{
+	link->next = NULL;
+	link->prev = list->tail;
+
+	if (list->tail)
+		list->tail->next = link;
+	else
+		list->head = link;
+
+	list->tail = link;
+	_ilist_init_link(list, link);
+}
+
+/**
+ *  Adds an element on to the start of a list.
+ *
+ *  @param list		a list
+ *  @param link		the link of the element, which mustn't be in any list
+ */
+void ilist_prepend(IList *list, ILink *link)
+{
+	link->prev = NULL;
+	link->next = list->head;
+
+	if (list->head)
+		list->head->prev = link;
+	else
+		list->tail = link;
+
+	list->head = link;
+	_ilist_init_link(list, link);
+}
+
+/**
+ *  Inserts an element in front of another element of a list.
+ *
+ *  @param list		a list
+ *  @param next		the element in front of which the new element is inserted or NULL to append it
+ *  @param link		the link of the element, which mustn't be in any list
+ */
+void ilist_insert_before(IList *list, ILink *next, ILink *link)
+{
+	if (!next) {
+		ilist_append(list, link);
+		return;
+	}
+
+	link->next = next;
+	link->prev = next->prev;
+
+	if (next->prev)
+		next->prev->next = link;
+	else
+		list->head = link;
+
+	next->prev = link;
+	_ilist_init_link(list, link);
+}
+
+/**
+ *  Removes an element from a list. If the list isn't walked right now, the element is
+ *  unlinked and passed to the release function immediately. Otherwise this is deferred
+ *  until the outermost walk has ended. Removing an element twice does nothing.
+ *
+ *  @param list		a list
+ *  @param link		the link of the element, which must be in this list
+ */
+void ilist_remove(IList *list, ILink *link)
+{
+	if (link->removed)
+		return;
+
+	link->removed = 1;
+	list->length--;
+
+	if (list->walking) {
+		link->next_removed = list->removed;
+		list->removed = link;
+	} else {
+		_ilist_unlink(list, link);
+	}
+}
+
+/**
+ *  Gets the element at a given position in a list. Removed elements are skipped.
+ *
+ *  @param list		a list
+ *  @param n		the position of the element, counting from 0
+ *
+ *  @returns		the element or NULL if the position is off the end of the list
+ */
+ILink * ilist_nth(IList *list, int n)
+{
+	ILink *link = list->head;
+
+	while (link) {
+		if (!link->removed && n-- == 0)
+			break;
+		link = link->next;
+	}
+
+	return link;
+}
+
+/**
+ *  Begins a walk through a list. Every call of this function must be followed by a
+ *  call of ilist_end(), even if the walk is aborted.
+ *
+ *  @param list		a list
+ *  @param iter		[out] state of the walk
+ *
+ *  @returns		the first element or NULL if the list is empty
+ */
+ILink * ilist_begin(IList *list, IListIter *iter)
+{
+	// Elements inserted from now on get the new generation and aren't visited
+	// by this walk, but by walks which begin later, even if they are nested.
+	list->walking++;
+	iter->list = list;
+	iter->generation = ++list->generation;
+
+	return _ilist_skip(iter, list->head);
+}
+
+/**
+ *  Gets the first element of a walk again, so that a list can be walked several times
+ *  with the same generation. Elements inserted since ilist_begin() are still skipped.
+ *
+ *  @param iter		state of the walk
+ *
+ *  @returns		the first element or NULL if the list is empty
+ */
+ILink * ilist_iter_first(IListIter *iter)
+{
+	return _ilist_skip(iter, iter->list->head);
+}
+
+/**
+ *  Gets the next element of a walk through a list.
+ *
+ *  @param iter		state of the walk
+ *  @param link		the current element
+ *
+ *  @returns		the next element or NULL if the end of the list has been reached
+ */
+ILink * ilist_iter_next(IListIter *iter, ILink *link)
+{
+	return _ilist_skip(iter, link->next);
+}
+
+/**
+ *  Ends a walk through a list. If this was the outermost walk, the elements removed
+ *  in the meantime are unlinked and passed to the release function.
+ *
+ *  @param iter		state of the walk
+ */
+void ilist_end(IListIter *iter)
+{
+	IList *list = iter->list;
+	ILink *link;
+
+	if (--list->walking > 0)
+		return;
+
+	// The release function might remove further elements, which are unlinked immediately
+	while (list->removed) {
+		link = list->removed;
+		list->removed = link->next_removed;
+		_ilist_unlink(list, link);
+	}
+}
+
+/** @} */
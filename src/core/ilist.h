@@ -0,0 +1,194 @@
+/*
+ * ilist.h
+ * This file is part of Arena1
+ *
+ * Copyright (C) 2013
+ *
+ * Arena1 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Arena1 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Arena1. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ *  @defgroup ilist ilist
+ *  @brief Provides functions to work with an intrusive doubly-linked list.
+ *
+ *  In contrast to the list module, the elements of an intrusive list aren't
+ *  allocated by the list. Instead, every object which shall be stored in a list
+ *  contains an ILink member. So appending and removing an object never allocates
+ *  memory and removing an object doesn't have to search for it.
+ *
+ *  The IList struct holds the first and the last element and the length of
+ *  the list, so that appending an element is done in constant time too.
+ *
+ *  A list may be walked by ilist_begin(), ilist_iter_next() and ilist_end(). During
+ *  such a walk elements may be removed and inserted, even by nested functions:
+ *  - A removed element is skipped, but it stays linked until the outermost walk
+ *    has ended. Then it is unlinked and passed to the release function of the list,
+ *    which usually frees the object. If the list isn't walked, this happens immediately.
+ *  - An element inserted during a walk isn't visited by it. Every walk gets a new
+ *    generation and every element is stamped with the generation at the time it
+ *    was inserted, so a walk only visits elements with an older stamp.
+ *
+ *  Example:
+ *  @code
+ *  typedef struct {
+ *  	int		 value;
+ *  	ILink	 link;
+ *  } Item;
+ *
+ *  IList items = ILIST_INIT(_item_release);
+ *  ilist_append(&items, &item->link);
+ *
+ *  IListIter iter;
+ *  ILink *link = ilist_begin(&items, &iter);
+ *  while (link) {
+ *  	Item *item = ilist_entry(link, Item, link);
+ *  	...
+ *  	link = ilist_iter_next(&iter, link);
+ *  }
+ *  ilist_end(&iter);
+ *  @endcode
+ *
+ *  @attention	An object can only be stored in one list per ILink member.
+ *
+ *  @attention	The plain macros ilist_first() and ilist_next() don't skip removed
+ *  			elements. They may only be used if the list isn't walked at the same time.
+ *
+ *  @{
+ */
+
+#ifndef ILIST_H_
+#define ILIST_H_
+
+#include <stddef.h>
+
+/**
+ *  The ILink struct is embedded into each object which is stored in an intrusive list.
+ */
+typedef struct _ILink ILink;
+struct _ILink {
+	ILink			*next;			/**< contains the link to the next element in the list */
+	ILink			*prev;			/**< contains the link to the previous element in the list */
+	ILink			*next_removed;	/**< the next element which is waiting to be unlinked */
+	unsigned int	 generation;	/**< generation of the list when the element was inserted */
+	int				 removed;		/**< whether the element has been removed during a walk */
+};
+
+/**
+ *  Prototype for a function which is called when an element has been unlinked
+ *  from a list, for example to free the object.
+ *
+ *  @param link		the link of the element
+ */
+typedef void (*IListReleaseFunc)(ILink *link);
+
+/**
+ *  The IList struct holds an intrusive list.
+ */
+typedef struct {
+	ILink			*head;			/**< the first element of the list */
+	ILink			*tail;			/**< the last element of the list */
+	int				 length;		/**< number of elements in the list, not counting removed ones */
+	int				 walking;		/**< number of nested walks */
+	unsigned int	 generation;	/**< incremented when a walk begins */
+	ILink			*removed;		/**< elements which have been removed during a walk */
+	IListReleaseFunc release;		/**< function called for unlinked elements or NULL */
+} IList;
+
+/**
+ *  The state of a walk through an intrusive list.
+ */
+typedef struct {
+	IList			*list;			/**< the list which is walked */
+	unsigned int	 generation;	/**< generation of the walk, only older elements are visited */
+} IListIter;
+
+/**
+ *  Initializer for an empty list.
+ *
+ *  @param release	function which is called for every element after it has been unlinked or NULL
+ */
+#define ILIST_INIT(release)			{ NULL, NULL, 0, 0, 0, NULL, release }
+
+/**
+ *  Gets the object which contains a link.
+ *
+ *  @param link		a link
+ *  @param type		type of the object
+ *  @param member	name of the ILink member in the object
+ *
+ *  @returns		a pointer to the object
+ */
+#define ilist_entry(link, type, member)	((type *)((char *)(link) - offsetof(type, member)))
+
+/**
+ *  A convenience macro to get the first element of a list.
+ *
+ *  @param list		a pointer to a list
+ *
+ *  @returns		the first element or NULL if the list is empty
+ */
+#define ilist_first(list)			((list)->head)
+
+/**
+ *  A convenience macro to get the last element of a list.
+ *
+ *  @param list		a pointer to a list
+ *
+ *  @returns		the last element or NULL if the list is empty
+ */
+#define ilist_last(list)			((list)->tail)
+
+/**
+ *  A convenience macro to get the next element in a list.
+ *
+ *  @param link		an element in a list
+ *
+ *  @returns		the next element or NULL if there are no next elements
+ */
+#define ilist_next(link)			((link)->next)
+
+/**
+ *  A convenience macro to get the previous element in a list.
+ *
+ *  @param link		an element in a list
+ *
+ *  @returns		the previous element or NULL if there are no previous elements
+ */
+#define ilist_prev(link)			((link)->prev)
+
+/**
+ *  A convenience macro to get the number of elements in a list.
+ *
+ *  @param list		a pointer to a list
+ *
+ *  @returns		the number of elements
+ */
+#define ilist_length(list)			((list)->length)
+
+extern void ilist_init(IList *list, IListReleaseFunc release);
+extern void ilist_append(IList *list, ILink *link);
+extern void ilist_prepend(IList *list, ILink *link);
+extern void ilist_insert_before(IList *list, ILink *next, ILink *link);
+extern void ilist_remove(IList *list, ILink *link);
+extern ILink * ilist_nth(IList *list, int n);
+
+extern ILink * ilist_begin(IList *list, IListIter *iter);
+extern ILink * ilist_iter_first(IListIter *iter);
+extern ILink * ilist_iter_next(IListIter *iter, ILink *link);
+extern void ilist_end(IListIter *iter);
+
+#endif /* ILIST_H_ */
+
+/** @} */
@@ -29,6 +29,7 @@
  */
 
 #include <stdlib.h>
+#include "pool.h"
 #include "list.h"
 
 
@@ -47,7 +48,7 @@ static List * _list_alloc_link()
 {
 	List *link;
 
-	link = (List *)malloc(sizeof(List));
+	link = (List *)pool_alloc(sizeof(List));
 	link->next = link->prev = NULL;
 
 	list_alloc_count++;
@@ -62,7 +63,7 @@ static List * _list_alloc_link()
  */
 static void _list_free_link(List *link)
 {
-	free(link);
+	pool_free(link, sizeof(List));
 	list_free_count++;
 }
 
@@ -0,0 +1,562 @@
+/*
+ * loop.c
+ * This file is part of Arena1
+ *
+ * Copyright (C) 2013
+ *
+ * Arena1 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Arena1 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Arena1. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ *  @addtogroup loop
+ *  @{
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <SDL/SDL.h>
+#include "common.h"
+#include "event.h"
+#include "clock.h"
+#include "timer.h"
+#include "loop.h"
+
+
+
+static Uint64	 step = 0;					/**< number of simulation steps done so far */
+static Uint64	 max_steps = 0;				/**< number of simulation steps after which the application quits, 0 for no limit */
+static float	 alpha = 0.0f;				/**< position of the rendered frame between the last two simulation steps */
+
+static int		 fps = LOOP_DEFAULT_FPS;	/**< number of frames rendered per second */
+static int		 max_frame_skip = LOOP_DEFAULT_FRAME_SKIP;	/**< maximal number of consecutive frames skipped while the simulation is behind */
+static int		 frames_skipped = 0;		/**< number of frames skipped since the last rendered frame */
+static Uint64	 frame_interval = 1000000000ULL / LOOP_DEFAULT_FPS;	/**< time between two frames in nanoseconds */
+static Uint64	 next_frame;				/**< time at which the next frame is due in nanoseconds */
+static Uint64	 last_frame = 0;			/**< time at which the last frame has been begun in nanoseconds */
+static LoopStats stats;						/**< statistics about the rendered frames */
+static bool		 running;					/**< whether the main loop runs, FALSE as soon as the application shall quit */
+
+static LoopInputMode input_mode = LOOP_INPUT_FRAME;	/**< when the SDL events are polled */
+static Uint64	 input_arrival = 0;			/**< arrival time of the oldest input event which hasn't been simulated yet, 0 if none */
+static Uint64	 input_step_arrival = 0;	/**< arrival time of the oldest input event which has been simulated but not presented yet, 0 if none */
+static Uint64	 input_step_done = 0;		/**< time at which the simulation step has been done which reflects this input event */
+
+static int		 tmr_step;					/**< id of the timer which drives the simulation */
+static int		 steps_due = 0;				/**< number of elapsed simulation steps which are done after the timers (see LOOP_INPUT_IMMEDIATE) */
+
+static int		 ev_sim_step;				/**< id of the sim-step event */
+static int		 ev_render;					/**< id of the render event */
+static int		 ev_sdl_key_down;			/**< id of the sdl-key-down event */
+static int		 ev_sdl_key_up;				/**< id of the sdl-key-up event */
+static int		 ev_sdl_mouse_down;			/**< id of the sdl-mouse-down event */
+static int		 ev_sdl_mouse_up;			/**< id of the sdl-mouse-up event */
+static int		 ev_sdl_mouse_motion;		/**< id of the sdl-mouse-motion event */
+static int		 ev_sdl_user;				/**< id of the sdl-user event */
+
+// --- Static Functions -------------------------------------------------------
+
+/**
+ *  Calculates how far the game clock has advanced since the last simulation step.
+ *
+ *  @returns		a value between 0 (the last step has just been done) and 1 (the next step is due)
+ */
+static float _loop_calc_alpha()
+{
+	Uint64 next = timer_get_next_deadline(tmr_step);
+	Uint64 now = clock_get_ns(CLOCK_GAME);
+	Uint64 step_ns = LOOP_SIM_STEP * 1000000ULL;
+
+	// The simulation is stopped or the next step is already due
+	if (!next || next <= now)
+		return 1.0f;
+
+	if (next - now >= step_ns)
+		return 0.0f;
+
+	return 1.0f - (float)(next - now) / step_ns;
+}
+
+/**
+ *  Renders a frame by raising the render event and records the statistics.
+ *
+ *  @param now		the current time in nanoseconds
+ */
+static void _loop_render(Uint64 now)
+{
+	Uint64 end;
+
+	histogram_add(&stats.lateness, now - next_frame);
+	if (now - next_frame > LOOP_LATE_NS)
+		stats.late++;
+	if (last_frame)
+		histogram_add(&stats.frame_time, now - last_frame);
+	last_frame = now;
+
+	alpha = _loop_calc_alpha();
+	event_raise_id(ev_render, &alpha);
+
+	end = time_get_ns();
+	histogram_add(&stats.present_time, end - now);
+	stats.frames++;
+	frames_skipped = 0;
+
+	// This frame presents the simulation steps which have been done since the last one
+	if (input_step_arrival) {
+		histogram_add(&stats.step_to_present, end - input_step_done);
+		histogram_add(&stats.input_to_present, end - input_step_arrival);
+		input_step_arrival = 0;
+	}
+
+	// Schedule the next frame. Frames which can't be rendered in time anymore are skipped.
+	next_frame += frame_interval;
+	if (next_frame <= end) {
+		stats.missed += (end - next_frame) / frame_interval + 1;
+		next_frame += ((end - next_frame) / frame_interval + 1) * frame_interval;
+	}
+}
+
+/**
+ *  Waits until the next frame is due. The main loop sleeps until shortly before
+ *  and spins for the rest of the time, because the system might wake it up too late.
+ */
+static void _loop_wait_frame()
+{
+	Uint64 now = time_get_ns();
+
+	if (next_frame > now + LOOP_SPIN_NS)
+		time_sleep_ns(next_frame - LOOP_SPIN_NS - now);
+
+	while (time_get_ns() < next_frame);
+}
+
+/**
+ *  Remembers the arrival of an input event, so its latency can be traced through the
+ *  simulation step and the frame which reflect it. Only input events which arrive while
+ *  the simulation runs are traced.
+ *
+ *  @param now		arrival time of the input event in nanoseconds
+ */
+static void _loop_trace_input(Uint64 now)
+{
+	if (clock_is_paused(CLOCK_GAME))
+		return;
+
+	stats.inputs++;
+	if (!input_arrival)
+		input_arrival = now;
+}
+
+/**
+ *  Raises the event which matches an SDL event.
+ *
+ *  @param event	an SDL event
+ *
+ *  @returns		FALSE if the application shall quit, otherwise TRUE
+ */
+static bool _loop_handle_event(SDL_Event *event)
+{
+	switch (event->type) {
+		case SDL_KEYDOWN:
+		case SDL_KEYUP:
+		case SDL_MOUSEBUTTONDOWN:
+		case SDL_MOUSEBUTTONUP:
+			_loop_trace_input(time_get_ns());
+			break;
+	}
+
+	switch (event->type) {
+		case SDL_QUIT:
+			return FALSE;
+
+		case SDL_KEYDOWN:
+			event_raise_id(ev_sdl_key_down, &event->key);
+			break;
+
+		case SDL_KEYUP:
+			event_raise_id(ev_sdl_key_up, &event->key);
+			break;
+
+		case SDL_MOUSEBUTTONDOWN:
+			event_raise_id(ev_sdl_mouse_down, &event->button);
+			break;
+
+		case SDL_MOUSEBUTTONUP:
+			event_raise_id(ev_sdl_mouse_up, &event->button);
+			break;
+
+		case SDL_MOUSEMOTION:
+			event_raise_id(ev_sdl_mouse_motion, &event->motion);
+			break;
+
+		case SDL_USEREVENT:
+			event_raise_id(ev_sdl_user, event);
+			break;
+	}
+
+	return TRUE;
+}
+
+/**
+ *  Raises the events of all pending SDL events and dispatches the events which
+ *  have been posted meanwhile.
+ */
+static void _loop_poll_events()
+{
+	SDL_Event event;
+
+	while (running && SDL_PollEvent(&event)) {
+		running = _loop_handle_event(&event);
+
+		// Dispatch the events which have been posted by other threads
+		// and the events which have been posted while processing these events
+		event_dispatch_async();
+		event_dispatch_posted();
+
+		// Input which has stopped the simulation isn't reflected by any step
+		if (clock_is_paused(CLOCK_GAME))
+			input_arrival = 0;
+	}
+}
+
+/**
+ *  Checks whether the simulation is behind, i.e. the next simulation step is already due.
+ *
+ *  @returns		TRUE if the simulation is behind, otherwise FALSE
+ */
+static bool _loop_sim_is_behind()
+{
+	Uint64 next = timer_get_next_deadline(tmr_step);
+
+	return !clock_is_paused(CLOCK_GAME) && next && next <= clock_get_ns(CLOCK_GAME);
+}
+
+/**
+ *  Skips a frame which is due, so the simulation can catch up.
+ */
+static void _loop_skip_frame()
+{
+	stats.skipped++;
+	frames_skipped++;
+	next_frame += frame_interval;
+}
+
+/**
+ *  Advances the simulation by one step by raising the sim-step event.
+ */
+static void _loop_step()
+{
+	Uint64 now;
+
+	step++;
+	event_raise_id(ev_sim_step, &step);
+
+	// The events posted during the step take effect before the next one
+	event_dispatch_posted();
+
+	// This step reflects all input events which have arrived since the last one
+	if (input_arrival) {
+		now = time_get_ns();
+		histogram_add(&stats.input_to_step, now - input_arrival);
+		if (!input_step_arrival) {
+			input_step_arrival = input_arrival;
+			input_step_done = now;
+		}
+		input_arrival = 0;
+	}
+
+	// Stop the simulation after the number of steps given by --ticks
+	if (step == max_steps) {
+		clock_set_paused(CLOCK_GAME, TRUE);
+		application_quit();
+	}
+}
+
+/**
+ *  Callback function for tmr_step.
+ *  Does a simulation step for every elapsed tick, so no step is lost if the main loop
+ *  has been late. Only after a stall of more than LOOP_MAX_STEPS steps the rest is dropped.
+ *  With LOOP_INPUT_IMMEDIATE the steps are only counted and done by _loop_do_due_steps().
+ *
+ *  @param user_data		NULL
+ */
+static void _loop_tmr_step(void *user_data)
+{
+	int ticks = timer_get_ticks();
+
+	if (ticks > LOOP_MAX_STEPS) {
+		stats.dropped_steps += ticks - LOOP_MAX_STEPS;
+		ticks = LOOP_MAX_STEPS;
+	}
+
+	// The events mustn't be dispatched while the timers are fired, so the steps which poll
+	// them are done afterwards. An unlimited clock doesn't wait for the input anyway.
+	if (input_mode == LOOP_INPUT_IMMEDIATE && !clock_is_unlimited(CLOCK_GAME)) {
+		steps_due += ticks;
+		return;
+	}
+
+	// A step may stop the simulation, e.g. by leaving the game
+	while (ticks-- > 0 && running && !clock_is_paused(CLOCK_GAME))
+		_loop_step();
+}
+
+/**
+ *  Does the simulation steps counted by _loop_tmr_step() with LOOP_INPUT_IMMEDIATE.
+ *  The SDL events are polled right before every step, so each step reflects all input
+ *  which has arrived until then, even while several steps are made up.
+ */
+static void _loop_do_due_steps()
+{
+	while (steps_due > 0) {
+		steps_due--;
+		_loop_poll_events();
+
+		// The input may have stopped the simulation, e.g. by leaving the game
+		if (!running || clock_is_paused(CLOCK_GAME))
+			break;
+
+		_loop_step();
+	}
+
+	steps_due = 0;
+}
+
+// --- Public Functions -------------------------------------------------------
+
+/**
+ *  Initializes this module.
+ */
+void loop_init()
+{
+	char *option;
+	int rate;
+
+	// Register the events raised by the main loop
+	ev_sim_step = event_register("sim-step");
+	ev_render = event_register("render");
+	ev_sdl_key_down = event_register("sdl-key-down");
+	ev_sdl_key_up = event_register("sdl-key-up");
+	ev_sdl_mouse_down = event_register("sdl-mouse-down");
+	ev_sdl_mouse_up = event_register("sdl-mouse-up");
+	ev_sdl_mouse_motion = event_register("sdl-mouse-motion");
+	ev_sdl_user = event_register("sdl-user");
+
+	// The simulation runs as long as the game clock runs
+	tmr_step = timer_create_interval(LOOP_SIM_STEP, _loop_tmr_step, NULL, TIMER_ENABLED);
+	timer_set_clock(tmr_step, CLOCK_GAME);
+	timer_set_policy(tmr_step, TIMER_POLICY_TICKS);
+
+	step = 0;
+	steps_due = 0;
+	alpha = 0.0f;
+	frames_skipped = 0;
+	input_arrival = input_step_arrival = 0;
+
+	// Set the frame rate given by --fps, an invalid rate is replaced by the default one
+	option = application_get_option("fps");
+	rate = option ? atoi(option) : LOOP_DEFAULT_FPS;
+	if (rate < 1) {
+		fprintf(stderr, "warning: invalid frame rate '%s', using %d fps\n", option, LOOP_DEFAULT_FPS);
+		rate = LOOP_DEFAULT_FPS;
+	}
+	loop_set_fps(rate);
+
+	// Skip at most the number of consecutive frames given by --max-frame-skip while the simulation is behind
+	option = application_get_option("max-frame-skip");
+	loop_set_max_frame_skip(option ? atoi(option) : LOOP_DEFAULT_FRAME_SKIP);
+
+	// Poll the input immediately before every simulation step if --input=immediate is given
+	option = application_get_option("input");
+	loop_set_input_mode((option && strcmp(option, "immediate") == 0) ? LOOP_INPUT_IMMEDIATE : LOOP_INPUT_FRAME);
+
+	// Limit the simulation to the number of steps given by --ticks
+	option = application_get_option("ticks");
+	max_steps = (option && atoi(option) > 0) ? atoi(option) : 0;
+
+	// Reset the statistics
+	memset(&stats, 0, sizeof(LoopStats));
+}
+
+/**
+ *  Destroys this module freeing any allocated data.
+ */
+void loop_destroy()
+{
+	// Free timers
+	timer_free(tmr_step);
+}
+
+/**
+ *  Runs the main loop until the application quits (see application_quit()).
+ */
+void loop_run()
+{
+	Uint64 now, next;
+	bool headless = application_is_headless();
+
+	next_frame = time_get_ns();
+	last_frame = 0;
+	running = TRUE;
+
+	while (running) {
+		// Process all pending events
+		_loop_poll_events();
+
+		// Advance the simulation and fire all other elapsed timers
+		timer_process();
+		_loop_do_due_steps();
+		event_dispatch_async();
+		event_dispatch_posted();
+
+		// Render a new frame if it is due. There are no frames if the application runs headless.
+		// While the simulation is behind, a limited number of frames is skipped, so it can catch up.
+		now = time_get_ns();
+		if (!headless && now >= next_frame) {
+			if (frames_skipped < max_frame_skip && _loop_sim_is_behind())
+				_loop_skip_frame();
+			else
+				_loop_render(now);
+		}
+
+		// Wait until the next timer elapses or the next frame is due. SDL 1.2 can't wait
+		// for an event with a timeout, so the sleep is limited to keep the latency of input events low.
+		now = time_get_ns();
+		next = timer_get_next_expiry();
+		if (!next || next > now + LOOP_MAX_SLEEP_NS)
+			next = now + LOOP_MAX_SLEEP_NS;
+
+		if (!headless && next_frame <= next)
+			_loop_wait_frame();
+		else if (next > now)
+			time_sleep_ns(next - now);
+	}
+}
+
+/**
+ *  Gets the number of simulation steps done so far.
+ *
+ *  @returns		the number of the last step
+ */
+Uint64 loop_get_step()
+{
+	return step;
+}
+
+/**
+ *  Gets the position of the frame being rendered between the last two simulation steps.
+ *  Objects which move smoothly should be drawn at the position
+ *  previous + (current - previous) * loop_get_alpha().
+ *
+ *  @attention	Only valid during a render event!
+ *
+ *  @returns		a value between 0 (at the previous step) and 1 (at the current step)
+ */
+float loop_get_alpha()
+{
+	return alpha;
+}
+
+/**
+ *  Sets the number of frames rendered per second.
+ *
+ *  @param rate		frames per second, e.g. 50, 60, 120 or 144. Values below 1 are ignored.
+ */
+void loop_set_fps(int rate)
+{
+	if (rate < 1)
+		return;
+
+	fps = rate;
+	frame_interval = 1000000000ULL / rate;
+}
+
+/**
+ *  Sets the maximal number of consecutive frames which are skipped while the simulation
+ *  is behind. Then at least every (limit + 1)th frame is rendered.
+ *
+ *  @param limit		number of frames, 0 never skips a frame. Negative values are ignored.
+ */
+void loop_set_max_frame_skip(int limit)
+{
+	if (limit < 0)
+		return;
+
+	max_frame_skip = limit;
+}
+
+/**
+ *  Sets when the main loop polls for SDL events (see LoopInputMode).
+ *
+ *  @param mode		the input mode
+ */
+void loop_set_input_mode(LoopInputMode mode)
+{
+	input_mode = mode;
+}
+
+/**
+ *  Gets the number of frames rendered per second.
+ *
+ *  @returns		frames per second
+ */
+int loop_get_fps()
+{
+	return fps;
+}
+
+/**
+ *  Gets the statistics about the rendered frames.
+ *
+ *  @attention	The returned statistics belong to this module, don't modify them!
+ *
+ *  @returns		the statistics
+ */
+LoopStats * loop_get_stats()
+{
+	return &stats;
+}
+
+/**
+ *  Prints the statistics about the rendered frames.
+ */
+void loop_print_stats()
+{
+	printf("frames (%d FPS): %llu  late: %llu  missed: %llu  skipped: %llu  simulation steps: %llu  dropped: %llu\n",
+			fps,
+			(unsigned long long)stats.frames,
+			(unsigned long long)stats.late,
+			(unsigned long long)stats.missed,
+			(unsigned long long)stats.skipped,
+			(unsigned long long)step,
+			(unsigned long long)stats.dropped_steps);
+	printf("-> frame time:   ");
+	histogram_print(&stats.frame_time);
+	printf("-> present time: ");
+	histogram_print(&stats.present_time);
+	printf("-> lateness:     ");
+	histogram_print(&stats.lateness);
+	printf("input events (%s): %llu\n",
+			(input_mode == LOOP_INPUT_IMMEDIATE) ? "immediate" : "per frame",
+			(unsigned long long)stats.inputs);
+	printf("-> input to step:    ");
+	histogram_print(&stats.input_to_step);
+	printf("-> step to present:  ");
+	histogram_print(&stats.step_to_present);
+	printf("-> input to present: ");
+	histogram_print(&stats.input_to_present);
+}
+
+/** @} */
@@ -0,0 +1,115 @@
+/*
+ * loop.h
+ * This file is part of Arena1
+ *
+ * Copyright (C) 2013
+ *
+ * Arena1 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Arena1 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Arena1. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ *  @defgroup loop loop
+ *  @brief Contains the main loop which drives the simulation and the rendering.
+ *
+ *  This module contains the main loop of the application. It dispatches the SDL events,
+ *  processes the timers and separates the simulation from the rendering:
+ *
+ *  - The simulation advances in fixed steps of LOOP_SIM_STEP milliseconds of the game
+ *    clock. For every step the "sim-step" event is raised with a pointer to the number
+ *    of the step. The events posted during a step are dispatched right after it (see
+ *    event_post()). Missed steps are made up, so the speed of the game doesn't depend on
+ *    the speed of the rendering. If the simulation is behind, up to LOOP_DEFAULT_FRAME_SKIP
+ *    (or --max-frame-skip) consecutive frames are skipped, so it can catch up.
+ *  - The rendering happens at a fixed frame rate of the real clock (LOOP_DEFAULT_FPS or
+ *    the option --fps) by raising the "render" event. Objects which move smoothly should be
+ *    drawn between their last two simulated positions, weighted by loop_get_alpha().
+ *
+ *  Between these steps the main loop sleeps, but it polls for new SDL events
+ *  at least every LOOP_MAX_SLEEP_NS nanoseconds. Because the system may wake up the
+ *  main loop too late, it sleeps only until LOOP_SPIN_NS nanoseconds before a frame
+ *  is due and spins for the rest of the time, so the frames are delivered evenly.
+ *
+ *  If the application runs headless (see application_is_headless()), no frames are rendered
+ *  and the main loop only waits for the timers. The option --ticks=N stops the simulation
+ *  and quits the application after N steps.
+ *
+ *  The frame times, the time needed to render a frame and the missed deadlines are
+ *  recorded. They can be queried by loop_get_stats() or printed by loop_print_stats().
+ *
+ *  Input events which arrive while the simulation runs are timestamped and traced to
+ *  the simulation step and the frame which reflect them, so the latency of the input is
+ *  recorded for each stage. By default the SDL events are polled once per pass of the main
+ *  loop. With --input=immediate they are also polled right before every simulation step,
+ *  which is then done after the other timers have been processed (see LoopInputMode).
+ *
+ *  @{
+ */
+
+#ifndef LOOP_H_
+#define LOOP_H_
+
+#include "common.h"
+#include "histogram.h"
+
+#define LOOP_SIM_STEP			20				/**< duration of a simulation step in milliseconds of the game clock */
+#define LOOP_DEFAULT_FPS		60				/**< number of frames rendered per second if no other rate is set */
+#define LOOP_MAX_SLEEP_NS		1000000ULL		/**< maximal time the main loop sleeps before it polls for new events again (1 ms) */
+#define LOOP_SPIN_NS			500000ULL		/**< time before a frame is due in which the main loop spins instead of sleeping (0.5 ms) */
+#define LOOP_DEFAULT_FRAME_SKIP	5				/**< maximal number of consecutive frames skipped while the simulation is behind, if no other limit is set */
+#define LOOP_MAX_STEPS			50				/**< maximal number of simulation steps made up at once, the rest of a longer stall is dropped (1 s) */
+#define LOOP_LATE_NS			1000000ULL		/**< a frame which is rendered later than this after its deadline counts as late (1 ms) */
+
+/**
+ *  When the main loop polls for SDL events.
+ */
+typedef enum {
+	LOOP_INPUT_FRAME     = 0x00,	/**< the events are polled once per pass of the main loop, before the timers are processed. This is the default. */
+	LOOP_INPUT_IMMEDIATE = 0x01,	/**< the events are additionally polled immediately before every simulation step, so the steps are done after the other timers of the same pass. */
+} LoopInputMode;
+
+/**
+ *  Statistics about the rendered frames and the latency of the input.
+ */
+typedef struct {
+	Uint64		frames;			/**< number of rendered frames */
+	Uint64		late;			/**< number of frames rendered more than LOOP_LATE_NS after their deadline */
+	Uint64		missed;			/**< number of frames which have been skipped because rendering was late by a whole frame */
+	Uint64		skipped;		/**< number of frames which have been skipped because the simulation was behind */
+	Uint64		dropped_steps;	/**< number of simulation steps which have been dropped after a stall of more than LOOP_MAX_STEPS steps */
+	Histogram	frame_time;		/**< time between the beginnings of two consecutive frames */
+	Histogram	present_time;	/**< time needed to render and present a frame */
+	Histogram	lateness;		/**< time between the deadline and the beginning of a frame */
+	Uint64		inputs;			/**< number of input events which have arrived while the simulation runs */
+	Histogram	input_to_step;	/**< time between the arrival of the oldest pending input event and the end of the simulation step which reflects it */
+	Histogram	step_to_present;	/**< time between this simulation step and the end of the frame which presents it */
+	Histogram	input_to_present;	/**< time between the arrival of the input event and the end of this frame */
+} LoopStats;
+
+extern void loop_init();
+extern void loop_destroy();
+
+extern void loop_run();
+extern Uint64 loop_get_step();
+extern float loop_get_alpha();
+extern void loop_set_fps(int fps);
+extern void loop_set_max_frame_skip(int limit);
+extern void loop_set_input_mode(LoopInputMode mode);
+extern int loop_get_fps();
+extern LoopStats * loop_get_stats();
+extern void loop_print_stats();
+
+#endif /* LOOP_H_ */
+
+/** @} */
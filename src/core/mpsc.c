@@ -0,0 +1,315 @@
+/*
+ * mpsc.c
+ * This file is part of Arena1
+ *
+ * Copyright (C) 2013
+ *
+ * Arena1 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Arena1 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Arena1. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ *  @addtogroup mpsc
+ *  @{
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <sched.h>
+#include <SDL/SDL.h>
+#include "mpsc.h"
+
+#define MPSC_CHECK_PRODUCERS	4			/**< number of producer threads of mpsc_self_check() */
+#define MPSC_CHECK_MESSAGES		200000		/**< number of messages pushed by each producer thread */
+#define MPSC_CHECK_CAPACITY		256			/**< capacity of the queue, small enough to overflow now and then */
+#define MPSC_CHECK_GIVE_UP		16			/**< every n-th message is dropped if the queue is full, the others are pushed again */
+
+/**
+ *  A producer thread of mpsc_self_check().
+ */
+typedef struct {
+	MpscQueue		*queue;			/**< the queue which is filled */
+	int				 id;			/**< number of the producer, used as id of its messages */
+	int				 n_pushed;		/**< number of messages which have been pushed */
+	int				 n_failed;		/**< number of pushes which have failed because the queue was full */
+	int				*n_running;		/**< number of producers which haven't finished yet */
+	SDL_Thread		*thread;		/**< the thread */
+} MpscCheckProducer;
+
+// --- Static Functions -------------------------------------------------------
+
+/**
+ *  Thread function of a producer of mpsc_self_check(). Pushes MPSC_CHECK_MESSAGES messages
+ *  as fast as possible, their data are the numbers 1, 2, 3 ... If the queue is full, a message
+ *  is pushed again until it fits, only every MPSC_CHECK_GIVE_UP-th message is dropped.
+ *
+ *  @param data		the MpscCheckProducer
+ *
+ *  @returns		always 0
+ */
+static int _mpsc_check_produce(void *data)
+{
+	MpscCheckProducer *producer = (MpscCheckProducer *)data;
+	intptr_t n;
+
+	for (n = 1; n <= MPSC_CHECK_MESSAGES; n++) {
+		for (;;) {
+			if (mpsc_push(producer->queue, producer->id, (void *)n)) {
+				producer->n_pushed++;
+				break;
+			}
+
+			producer->n_failed++;
+			if (n % MPSC_CHECK_GIVE_UP == 0)
+				break;
+
+			// Let the consumer run, there may be fewer processors than threads
+			sched_yield();
+		}
+	}
+
+	// All pushes happen before the consumer sees the producer finished
+	__atomic_fetch_sub(producer->n_running, 1, __ATOMIC_RELEASE);
+
+	return 0;
+}
+
+// --- Public Functions -------------------------------------------------------
+
+
+/**
+ *  Creates a new empty queue.
+ *
+ *  @param capacity		the minimal number of messages the queue can hold (it is rounded up to a power of two)
+ *
+ *  @returns			the new queue
+ */
+MpscQueue * mpsc_new(int capacity)
+{
+	MpscQueue *queue;
+	unsigned int size = 2;
+	unsigned int i;
+
+	while (size < (unsigned int)capacity)
+		size *= 2;
+
+	queue = (MpscQueue *)malloc(sizeof(MpscQueue));
+	queue->cells = (MpscCell *)malloc(size * sizeof(MpscCell));
+	queue->mask = size - 1;
+	queue->head = 0;
+	queue->tail = 0;
+	queue->overflow_count = 0;
+
+	// Every cell is free for the position it has in the first round
+	for (i = 0; i < size; i++)
+		queue->cells[i].sequence = i;
+
+	return queue;
+}
+
+/**
+ *  Frees all of the memory used by a queue.
+ *
+ *  @attention	Make sure that no other thread uses the queue anymore!
+ *
+ *  @param queue	a queue
+ */
+void mpsc_free(MpscQueue *queue)
+{
+	if (!queue)
+		return;
+
+	free(queue->cells);
+	free(queue);
+}
+
+/**
+ *  Pushes a message into the queue. This function may be called by any thread.
+ *
+ *  @param queue	a queue
+ *  @param id		id of the message
+ *  @param data		data of the message
+ *
+ *  @returns		TRUE, if the message has been pushed. FALSE, if the queue was full.
+ */
+bool mpsc_push(MpscQueue *queue, int id, void *data)
+{
+	MpscCell *cell;
+	unsigned int pos, sequence;
+	int diff;
+
+	pos = __atomic_load_n(&queue->head, __ATOMIC_RELAXED);
+	for (;;) {
+		cell = &queue->cells[pos & queue->mask];
+		sequence = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+		diff = (int)(sequence - pos);
+
+		if (diff == 0) {
+			// The cell is free, try to claim the position
+			if (__atomic_compare_exchange_n(&queue->head, &pos, pos + 1, TRUE, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+				break;
+		}
+		else if (diff < 0) {
+			// The cell still holds a message of the last round, the queue is full
+			__atomic_fetch_add(&queue->overflow_count, 1, __ATOMIC_RELAXED);
+			return FALSE;
+		}
+		else {
+			// Another producer has claimed the position, try again
+			pos = __atomic_load_n(&queue->head, __ATOMIC_RELAXED);
+		}
+	}
+
+	// Store the message and hand the cell over to the consumer
+	cell->id = id;
+	cell->data = data;
+	__atomic_store_n(&cell->sequence, pos + 1, __ATOMIC_RELEASE);
+
+	return TRUE;
+}
+
+/**
+ *  Pops a message from the queue.
+ *
+ *  @attention	This function must always be called by the same thread!
+ *
+ *  @param queue	a queue
+ *  @param id		[out] where to store the id of the message
+ *  @param data		[out] where to store the data of the message
+ *
+ *  @returns		TRUE, if a message has been popped. FALSE, if the queue is empty.
+ */
+bool mpsc_pop(MpscQueue *queue, int *id, void **data)
+{
+	MpscCell *cell;
+	unsigned int pos = queue->tail;
+	unsigned int sequence;
+
+	cell = &queue->cells[pos & queue->mask];
+	sequence = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+
+	// Is the message of this position complete?
+	if ((int)(sequence - (pos + 1)) < 0)
+		return FALSE;
+
+	*id = cell->id;
+	*data = cell->data;
+
+	// Free the cell for the producers of the next round
+	__atomic_store_n(&cell->sequence, pos + queue->mask + 1, __ATOMIC_RELEASE);
+	queue->tail = pos + 1;
+
+	return TRUE;
+}
+
+/**
+ *  Gets the number of messages which have been dropped because the queue was full.
+ *
+ *  @param queue	a queue
+ *
+ *  @returns		the number of dropped messages
+ */
+unsigned int mpsc_get_overflow_count(MpscQueue *queue)
+{
+	return __atomic_load_n(&queue->overflow_count, __ATOMIC_RELAXED);
+}
+
+/**
+ *  Checks the queue with several threads. MPSC_CHECK_PRODUCERS threads fill a small queue
+ *  at the same time while the calling thread empties it. Every pushed message must arrive
+ *  exactly once and in the order of its producer, and every failed push must have been
+ *  counted as overflow. Afterwards the overflow of a full queue is checked without any threads.
+ *  The result is printed to stdout.
+ *
+ *  @returns		TRUE, if the queue has passed all checks.
+ */
+bool mpsc_self_check()
+{
+	MpscCheckProducer a_producers[MPSC_CHECK_PRODUCERS];
+	intptr_t a_last[MPSC_CHECK_PRODUCERS] = { 0 };
+	int a_received[MPSC_CHECK_PRODUCERS] = { 0 };
+	MpscQueue *queue;
+	void *data;
+	unsigned int failed = 0;
+	int n_running = MPSC_CHECK_PRODUCERS;
+	int received = 0, errors = 0;
+	int i, id;
+	bool done;
+
+	queue = mpsc_new(MPSC_CHECK_CAPACITY);
+
+	for (i = 0; i < MPSC_CHECK_PRODUCERS; i++) {
+		a_producers[i].queue = queue;
+		a_producers[i].id = i;
+		a_producers[i].n_pushed = 0;
+		a_producers[i].n_failed = 0;
+		a_producers[i].n_running = &n_running;
+		a_producers[i].thread = SDL_CreateThread(_mpsc_check_produce, &a_producers[i]);
+	}
+
+	// Empty the queue until all producers have finished. The queue is emptied once
+	// more afterwards, so the messages pushed last aren't missed.
+	do {
+		done = (__atomic_load_n(&n_running, __ATOMIC_ACQUIRE) == 0);
+		sched_yield();
+
+		while (mpsc_pop(queue, &id, &data)) {
+			received++;
+			if (id < 0 || id >= MPSC_CHECK_PRODUCERS || (intptr_t)data <= a_last[id]) {
+				errors++;
+				continue;
+			}
+			a_last[id] = (intptr_t)data;
+			a_received[id]++;
+		}
+	} while (!done);
+
+	for (i = 0; i < MPSC_CHECK_PRODUCERS; i++) {
+		SDL_WaitThread(a_producers[i].thread, NULL);
+		if (a_received[i] != a_producers[i].n_pushed)
+			errors++;
+		failed += a_producers[i].n_failed;
+	}
+
+	// Every failed push must have been counted
+	if (mpsc_get_overflow_count(queue) != failed)
+		errors++;
+
+	printf("mpsc self-check: %d producers pushed %d messages, %d received, %u pushes failed\n",
+			MPSC_CHECK_PRODUCERS, MPSC_CHECK_PRODUCERS * MPSC_CHECK_MESSAGES, received, failed);
+	mpsc_free(queue);
+
+	// A full queue drops exactly the messages which don't fit and keeps the others in order
+	queue = mpsc_new(MPSC_CHECK_CAPACITY);
+	for (i = 0; i < MPSC_CHECK_CAPACITY + 10; i++) {
+		if (mpsc_push(queue, i, NULL) != (i < MPSC_CHECK_CAPACITY))
+			errors++;
+	}
+	if (mpsc_get_overflow_count(queue) != 10)
+		errors++;
+	for (i = 0; mpsc_pop(queue, &id, &data); i++) {
+		if (id != i)
+			errors++;
+	}
+	if (i != MPSC_CHECK_CAPACITY)
+		errors++;
+	mpsc_free(queue);
+
+	printf("mpsc self-check: %s (%d errors)\n", errors ? "FAILED" : "passed", errors);
+
+	return !errors;
+}
+
+/** @} */
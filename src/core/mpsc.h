@@ -0,0 +1,83 @@
+/*
+ * mpsc.h
+ * This file is part of Arena1
+ *
+ * Copyright (C) 2013
+ *
+ * Arena1 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Arena1 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Arena1. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ *  @defgroup mpsc mpsc
+ *  @brief Provides a bounded lock-free queue for passing messages between threads.
+ *
+ *  This module provides a bounded queue which can be filled by any number of threads
+ *  at the same time (multiple producers) while a single thread takes the messages
+ *  out of it (single consumer). No locks are used, so a producer never blocks.
+ *  If the queue is full, the message is dropped and an overflow counter is
+ *  incremented instead.
+ *
+ *  A message consists of an integer id and a pointer.
+ *
+ *  mpsc_self_check() fills a queue from several threads at once and checks what arrives,
+ *  it is run by passing --check-mpsc.
+ *
+ *  @{
+ */
+
+#ifndef MPSC_H_
+#define MPSC_H_
+
+#include "common.h"
+
+#define MPSC_CACHE_LINE		64		/**< size of a cache line, used to keep the producer and consumer data apart */
+
+/**
+ *  A cell of the queue.
+ *
+ *  @private
+ */
+typedef struct {
+	unsigned int	 sequence;		/**< tells whether the cell is free or holds a message */
+	int				 id;			/**< id of the message */
+	void			*data;			/**< data of the message */
+} MpscCell;
+
+/**
+ *  The MpscQueue struct holds the cells and the positions of the producers and the consumer.
+ */
+typedef struct {
+	MpscCell		*cells;											/**< array of cells */
+	unsigned int	 mask;											/**< number of cells minus one */
+	char			 pad0[MPSC_CACHE_LINE];
+	unsigned int	 head;											/**< position of the next message to push (shared by the producers) */
+	unsigned int	 overflow_count;								/**< number of messages dropped because the queue was full */
+	char			 pad1[MPSC_CACHE_LINE];
+	unsigned int	 tail;											/**< position of the next message to pop (consumer only) */
+} MpscQueue;
+
+extern MpscQueue * mpsc_new(int capacity);
+extern void mpsc_free(MpscQueue *queue);
+
+extern bool mpsc_push(MpscQueue *queue, int id, void *data);
+extern bool mpsc_pop(MpscQueue *queue, int *id, void **data);
+
+extern unsigned int mpsc_get_overflow_count(MpscQueue *queue);
+
+extern bool mpsc_self_check();
+
+#endif /* MPSC_H_ */
+
+/** @} */
@@ -0,0 +1,233 @@
+/*
+ * pool.c
+ * This file is part of Arena1
+ *
+ * Copyright (C) 2013
+ *
+ * Arena1 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Arena1 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Arena1. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ *  @addtogroup pool
+ *  @{
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include "pool.h"
+
+
+
+#define POOL_CLASSES			(POOL_MAX_SIZE / POOL_GRANULARITY)	/**< number of size classes */
+
+/**
+ *  A free block. The pointer to the next free block is stored in the block itself.
+ *
+ *  @private
+ */
+typedef struct _PoolBlock PoolBlock;
+struct _PoolBlock {
+	PoolBlock			*next;			/**< the next free block of the same size class */
+};
+
+/**
+ *  The header of a slab. It is padded, so that the blocks behind it are aligned.
+ *
+ *  @private
+ */
+typedef union _PoolSlab PoolSlab;
+union _PoolSlab {
+	PoolSlab			*next;			/**< the next slab of the same size class */
+	char				 pad[POOL_GRANULARITY];
+};
+
+/**
+ *  A struct which holds several informations about a size class.
+ *
+ *  @private
+ */
+typedef struct {
+	PoolBlock			*free_list;		/**< the free blocks of this size class */
+	PoolSlab			*slabs;			/**< all slabs of this size class */
+	int					 n_slabs;		/**< number of slabs */
+	int					 n_used;		/**< number of blocks which are currently allocated */
+} PoolClass;
+
+static PoolClass a_classes[POOL_CLASSES];	/**< the size classes, indexed by size / POOL_GRANULARITY - 1 */
+
+#ifdef DEBUG
+int malloc_count = 0;		/**< may be used for debugging */
+int free_count = 0;			/**< may be used for debugging */
+#endif
+
+// --- Static Functions -------------------------------------------------------
+
+/**
+ *  Takes a new slab from the system and puts all of its blocks into
+ *  the free list of a size class.
+ *
+ *  @param index	index of the size class
+ */
+static void _pool_grow(int index)
+{
+	PoolClass *class = &a_classes[index];
+	size_t block_size = (index + 1) * POOL_GRANULARITY;
+	PoolSlab *slab;
+	PoolBlock *block;
+	char *ptr, *end;
+
+	slab = (PoolSlab *)malloc(POOL_SLAB_SIZE);
+	slab->next = class->slabs;
+	class->slabs = slab;
+	class->n_slabs++;
+
+	// Divide the slab into blocks. They are pushed in reverse order, so
+	// that the blocks are handed out in the order of their addresses.
+	ptr = (char *)(slab + 1);
+	end = (char *)slab + POOL_SLAB_SIZE - block_size;
+
+	while (end >= ptr) {
+		block = (PoolBlock *)end;
+		block->next = class->free_list;
+		class->free_list = block;
+		end -= block_size;
+	}
+}
+
+// --- Public Functions -------------------------------------------------------
+
+/**
+ *  Initializes this module.
+ */
+void pool_init()
+{
+	int i;
+
+	for (i = 0; i < POOL_CLASSES; i++) {
+		a_classes[i].free_list = NULL;
+		a_classes[i].slabs = NULL;
+		a_classes[i].n_slabs = 0;
+		a_classes[i].n_used = 0;
+	}
+}
+
+/**
+ *  Destroys this module giving all slabs back to the system.
+ *
+ *  @attention	All blocks which have been allocated by pool_alloc() are invalid afterwards!
+ */
+void pool_destroy()
+{
+	PoolSlab *slab;
+	int i;
+
+	for (i = 0; i < POOL_CLASSES; i++) {
+		while (a_classes[i].slabs) {
+			slab = a_classes[i].slabs;
+			a_classes[i].slabs = slab->next;
+			free(slab);
+		}
+	}
+
+	pool_init();
+}
+
+/**
+ *  Allocates a block of memory. The block is aligned to POOL_GRANULARITY bytes.
+ *
+ *  @param size		size of the block in bytes
+ *
+ *  @returns		a pointer to the allocated block
+ */
+void * pool_alloc(size_t size)
+{
+	PoolClass *class;
+	PoolBlock *block;
+	int index;
+
+#ifdef DEBUG
+	malloc_count++;
+#endif
+
+	// Large blocks are taken from the system directly
+	if (size > POOL_MAX_SIZE || size == 0)
+		return malloc(size);
+
+	index = (size - 1) / POOL_GRANULARITY;
+	class = &a_classes[index];
+
+	if (!class->free_list)
+		_pool_grow(index);
+
+	// Take the first free block
+	block = class->free_list;
+	class->free_list = block->next;
+	class->n_used++;
+
+	return block;
+}
+
+/**
+ *  Frees a block of memory which has been allocated by pool_alloc(). The
+ *  block is put into the free list of its size class. Passing NULL does nothing.
+ *
+ *  @param ptr		a pointer to the block
+ *  @param size		size of the block in bytes, as passed to pool_alloc()
+ */
+void pool_free(void *ptr, size_t size)
+{
+	PoolClass *class;
+	PoolBlock *block;
+
+	if (!ptr)
+		return;
+
+#ifdef DEBUG
+	free_count++;
+#endif
+
+	if (size > POOL_MAX_SIZE || size == 0) {
+		free(ptr);
+		return;
+	}
+
+	class = &a_classes[(size - 1) / POOL_GRANULARITY];
+
+	block = (PoolBlock *)ptr;
+	block->next = class->free_list;
+	class->free_list = block;
+	class->n_used--;
+}
+
+/**
+ *  Prints the number of slabs and used blocks of every size class to stdout.
+ *  This may be useful to find leaks.
+ */
+void pool_print_stats()
+{
+	int i;
+
+	for (i = 0; i < POOL_CLASSES; i++) {
+		if (!a_classes[i].n_slabs)
+			continue;
+
+		printf("pool %3d bytes: %3d slabs  %5d blocks used\n",
+				(i + 1) * POOL_GRANULARITY,
+				a_classes[i].n_slabs,
+				a_classes[i].n_used);
+	}
+}
+
+/** @} */
@@ -0,0 +1,66 @@
+/*
+ * pool.h
+ * This file is part of Arena1
+ *
+ * Copyright (C) 2013
+ *
+ * Arena1 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Arena1 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Arena1. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ *  @defgroup pool pool
+ *  @brief Provides a fast allocator for small objects.
+ *
+ *  This module provides an allocator for small objects of a fixed size, like
+ *  list elements, event handlers, timers and game objects. Memory is taken from
+ *  the system in slabs of POOL_SLAB_SIZE bytes and divided into blocks of one
+ *  size class. Freed blocks are kept in a free list per size class and are handed
+ *  out again by the next allocation of the same size class, so allocating and
+ *  freeing a block only takes a few instructions.
+ *
+ *  Requests which are larger than POOL_MAX_SIZE bytes are passed to malloc().
+ *
+ *  @note	In contrast to free(), pool_free() needs the size of the block which
+ *  		has been passed to pool_alloc().
+ *
+ *  @attention	This module isn't thread-safe, it must only be used by the main thread!
+ *
+ *  @{
+ */
+
+#ifndef POOL_H_
+#define POOL_H_
+
+#include <stddef.h>
+
+#define POOL_GRANULARITY		16		/**< the size classes are multiples of this value, it is also the alignment of the blocks */
+#define POOL_MAX_SIZE			1024	/**< the largest size which is served by the pool */
+#define POOL_SLAB_SIZE			16384	/**< size in bytes of the slabs taken from the system */
+
+extern void pool_init();
+extern void pool_destroy();
+
+extern void * pool_alloc(size_t size);
+extern void pool_free(void *ptr, size_t size);
+extern void pool_print_stats();
+
+#ifdef DEBUG
+extern int malloc_count;
+extern int free_count;
+#endif
+
+#endif /* POOL_H_ */
+
+/** @} */
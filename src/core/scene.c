@@ -30,13 +30,48 @@
 
 
 
-static List *l_state_stack = NULL;		/**< the stack containing the scenes */
+#define SCENE_NAME_MAX_LENGTH	32		/**< the maximum length of a scene name (including null-terminator) */
+
+static char	   **a_scenes = NULL;		/**< array which contains the names of all registered scenes, indexed by scene id minus one */
+static int		 n_scenes = 0;			/**< number of scenes in the a_scenes array */
+static int		 scenes_size = 0;		/**< number of allocated elements of the a_scenes array */
+static HashMap	*m_scenes = NULL;		/**< map which holds the ids of all registered scenes by their name */
+
+static int		*a_stack = NULL;		/**< the stack containing the ids of the scenes, the last element is the active scene */
+static int		 stack_length = 0;		/**< number of scenes on the stack */
+static int		 stack_size = 0;		/**< number of allocated elements of the stack */
+
+static int		 ev_scene_changed;		/**< id of the scene-changed event */
+
+// --- Static Functions -------------------------------------------------------
+
+/**
+ *  Activates a scene. The groups which are bound to the scene are activated
+ *  and the scene-changed event is raised.
+ *
+ *  @param scene	id of the scene which is on top of the stack now
+ */
+static void _scene_changed(int scene)
+{
+	group_apply_scene(scene);
+
+	// Raise an event to notify about the change
+	event_raise_id(ev_scene_changed, scene_get_name(scene));
+}
+
+// --- Public Functions -------------------------------------------------------
 
 /**
  *  Initializes this module.
  */
 void scene_init()
 {
+	// Register events
+	ev_scene_changed = event_register("scene-changed");
+
+	// Create the map for the scene names
+	m_scenes = hashmap_new_str();
+
 	// This is our first state
 	scene_push("init");
 }
@@ -46,45 +81,136 @@ void scene_init()
  */
 void scene_destroy()
 {
-	// Destroy the list
-	list_free_full(l_state_stack, free);
+	int i;
+
+	// Free the stack
+	free(a_stack);
+	a_stack = NULL;
+	stack_length = stack_size = 0;
+
+	// Free the names of the scenes
+	for (i = 0; i < n_scenes; i++)
+		free(a_scenes[i]);
+	free(a_scenes);
+	a_scenes = NULL;
+	n_scenes = scenes_size = 0;
+	hashmap_free(m_scenes);
+	m_scenes = NULL;
+}
+
+/**
+ *  Registers a scene and returns its id. If the scene already exists, the id of the
+ *  existing scene is returned. The id can be used with scene_push_id(), scene_check_id()
+ *  and group_bind_scene().
+ *
+ *  @param name		name of the scene
+ *
+ *  @returns		the id of the scene or 0 if the name is too long
+ */
+int scene_register(char *name)
+{
+	int id;
+
+	// Check whether the passed name is too long
+	if (strlen(name) > SCENE_NAME_MAX_LENGTH - 1)
+		return 0;
+
+	// Does the scene already exist?
+	id = (intptr_t)hashmap_lookup_str(m_scenes, name);
+	if (id)
+		return id;
+
+	// Grow the array if it is full
+	if (n_scenes == scenes_size) {
+		scenes_size = (scenes_size) ? scenes_size * 2 : 8;
+		a_scenes = (char **)realloc(a_scenes, scenes_size * sizeof(char *));
+	}
+
+	// Store a copy of the name
+	a_scenes[n_scenes] = (char *)malloc(strlen(name) + 1);
+	strcpy(a_scenes[n_scenes], name);
+	hashmap_insert_str(m_scenes, a_scenes[n_scenes], (void *)(intptr_t)(n_scenes + 1));
+
+	return ++n_scenes;
 }
 
 /**
  *  Pushes a new scene onto the stack. This raises the scene-changed event.
  *
+ *  This is a convenience wrapper around scene_register() and scene_push_id().
+ *
  *  @param name		name of the new scene
  */
 void scene_push(char *name)
 {
-	char *cpy;
+	scene_push_id(scene_register(name));
+}
+
+/**
+ *  Pushes a new scene specified by its id onto the stack. This raises
+ *  the scene-changed event.
+ *
+ *  @param scene	id of the new scene as returned by scene_register()
+ */
+void scene_push_id(int scene)
+{
+	if (!scene_get_name(scene))
+		return;
 
-	// Create a copy of the name
-	cpy = (char *)malloc(strlen(name) + 1);
-	strcpy(cpy, name);
+	// Grow the stack if it is full
+	if (stack_length == stack_size) {
+		stack_size = (stack_size) ? stack_size * 2 : 8;
+		a_stack = (int *)realloc(a_stack, stack_size * sizeof(int));
+	}
 
 	// Push it onto our app state stack
-	l_state_stack = list_prepend(l_state_stack, cpy);
+	a_stack[stack_length++] = scene;
 
-	// Raise an event to notify about the change
-	event_raise("scene-changed", cpy);
+	_scene_changed(scene);
 }
 
 /**
  *  Gets the currently active scene.
  *
- *  @attention	The returned pointer is a pointer to the string on the
- *  			stack itself, do NOT modify or free it!
+ *  @attention	The returned pointer is a pointer to the registered name
+ *  			of the scene, do NOT modify or free it!
  *
  *  @return		currently active scene
  */
 char * scene_get()
+{
+	return scene_get_name(scene_get_id());
+}
+
+/**
+ *  Gets the id of the currently active scene.
+ *
+ *  @return		id of the currently active scene or 0 if the stack is empty
+ */
+int scene_get_id()
 {
 	// This should never happen because of the "init" state
-	if (!l_state_stack)
+	if (!stack_length)
+		return 0;
+
+	return a_stack[stack_length - 1];
+}
+
+/**
+ *  Gets the name of a scene specified by its id.
+ *
+ *  @attention	Don't modify or free the returned string!
+ *
+ *  @param scene	id of the scene
+ *
+ *  @returns		name of the scene or NULL if the id is invalid
+ */
+char * scene_get_name(int scene)
+{
+	if (scene < 1 || scene > n_scenes)
 		return NULL;
 
-	return (char *)list_first(l_state_stack)->data;
+	return a_scenes[scene - 1];
 }
 
 /**
@@ -93,38 +219,32 @@ char * scene_get()
  *  @note		The returned scene is the scene which is active after the
  *  			call of this function, not the scene which has been popped.
  *
- *  @attention	The returned pointer is a pointer to the string on the
- *  			stack itself, do NOT modify or free it!
+ *  @attention	The returned pointer is a pointer to the registered name
+ *  			of the scene, do NOT modify or free it!
  *
  *  @returns	the new scene (not the scene which has been popped!)
  */
 char * scene_pop()
 {
-	List *state_link;
-
-	// This should never happen because of the "init" state
-	if (!l_state_stack)
-		return NULL;
-
-	// Pop an app state from the stack and free it
-	state_link = list_first(l_state_stack);
-	free(state_link->data);
-	l_state_stack = list_delete_link(l_state_stack, state_link);
+	// Never pop the "init" state
+	if (stack_length < 2)
+		return scene_get();
 
-	char *new_scene = scene_get();
+	// Pop an app state from the stack
+	stack_length--;
 
-	// Raise an event to notify about the change
-	event_raise("scene-changed", new_scene);
+	_scene_changed(scene_get_id());
 
 	// Hopefully not too confusing: This function does return the new app state,
 	// not the app state which has been popped from the stack.
-	return new_scene;
+	return scene_get();
 }
 
 /**
  *  Checks, whether a specified scene is the active one.
- *  This is a convenience function which avoids using of the
- *  strcmp function of the string.h library in every module.
+ *
+ *  @note		Modules which check the scene often should use scene_check_id()
+ *  			which doesn't have to look up the scene by its name.
  *
  *  @param name		the scene to compare with
  *
@@ -132,7 +252,19 @@ char * scene_pop()
  */
 int scene_check(char *name)
 {
-	return strcmp(scene_get(), name) == 0;
+	return scene_get_id() == (intptr_t)hashmap_lookup_str(m_scenes, name);
+}
+
+/**
+ *  Checks, whether a scene specified by its id is the active one.
+ *
+ *  @param scene	id of the scene as returned by scene_register()
+ *
+ *  @returns		1, if the given scene is the active one
+ */
+int scene_check_id(int scene)
+{
+	return scene_get_id() == scene;
 }
 
 /** @} */
@@ -35,7 +35,12 @@
  *  in the "main-menu" scene. We can fall back to the main menu simply by
  *  calling the scene_pop() function which requires no other arguments.
  *
- *  @note	A scene is nothing else than a string which identifies it.
+ *  @note	A scene is nothing else than a string which identifies it. Every scene
+ *  		gets an integer id when it is registered for the first time (see scene_register()).
+ *  		Modules which check the scene often should keep this id and use scene_check_id().
+ *
+ *  Groups of event handlers and timers can be bound to a scene (see group_bind_scene()),
+ *  they are activated and deactivated automatically when the scene changes.
  *
  *  @note	You should make sure that scenes which are pushed, are popped
  *  		later to avoid a constantly growing stack.
@@ -49,10 +54,15 @@
 extern void scene_init();
 extern void scene_destroy();
 
+extern int scene_register(char *name);
 extern void scene_push(char *name);
+extern void scene_push_id(int scene);
 extern char * scene_pop();
 extern char * scene_get();
+extern int scene_get_id();
+extern char * scene_get_name(int scene);
 extern int scene_check(char *name);
+extern int scene_check_id(int scene);
 
 #endif /* SCENE_H_ */
 
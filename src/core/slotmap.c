@@ -0,0 +1,202 @@
+/*
+ * slotmap.c
+ * This file is part of Arena1
+ *
+ * Copyright (C) 2013
+ *
+ * Arena1 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Arena1 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Arena1. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ *  @addtogroup slotmap
+ *  @{
+ */
+
+#include <stdlib.h>
+#include "slotmap.h"
+
+
+// --- Private ---
+
+/**
+ *  Splits an id into its slot index and generation and checks whether the
+ *  slot still belongs to this id.
+ *
+ *  @param map		a slot map
+ *  @param id		an id returned by slotmap_insert()
+ *
+ *  @returns		the slot or NULL if the id is invalid or stale
+ */
+static SlotMapEntry * _slotmap_get_entry(SlotMap *map, int id)
+{
+	int index = id & (SLOTMAP_MAX_SLOTS - 1);
+	int generation = id >> SLOTMAP_INDEX_BITS;
+	SlotMapEntry *entry;
+
+	if (id <= 0 || index >= map->length)
+		return NULL;
+
+	entry = &map->entries[index];
+	if (entry->generation != generation || !entry->data)
+		return NULL;
+
+	return entry;
+}
+
+// --- Creating ---
+
+/**
+ *  Creates a new empty slot map.
+ *
+ *  @returns		the new slot map
+ */
+SlotMap * slotmap_new()
+{
+	SlotMap *map = (SlotMap *)malloc(sizeof(SlotMap));
+
+	map->entries = NULL;
+	map->size = 0;
+	map->length = 0;
+	map->count = 0;
+	map->free_head = -1;
+
+	return map;
+}
+
+/**
+ *  Frees all of the memory used by a slot map.
+ *
+ *  @note	The stored data isn't freed. Use slotmap_foreach() to free it first.
+ *
+ *  @param map		a slot map
+ */
+void slotmap_free(SlotMap *map)
+{
+	if (!map)
+		return;
+
+	free(map->entries);
+	free(map);
+}
+
+// --- Using ---
+
+/**
+ *  Stores data in a free slot of the map.
+ *
+ *  @param map		a slot map
+ *  @param data		the data to store (must not be NULL)
+ *
+ *  @returns		the id which refers to the data or 0 if the map is full
+ */
+int slotmap_insert(SlotMap *map, void *data)
+{
+	SlotMapEntry *entry;
+	int index;
+
+	if (map->free_head >= 0) {
+		// Reuse a released slot
+		index = map->free_head;
+		entry = &map->entries[index];
+		map->free_head = entry->next_free;
+	}
+	else {
+		// All slots are in use, take a new one
+		if (map->length == SLOTMAP_MAX_SLOTS)
+			return 0;
+
+		// Grow the array if it is full
+		if (map->length == map->size) {
+			map->size = (map->size) ? map->size * 2 : 16;
+			map->entries = (SlotMapEntry *)realloc(map->entries, map->size * sizeof(SlotMapEntry));
+		}
+
+		index = map->length++;
+		entry = &map->entries[index];
+		entry->generation = 1;
+	}
+
+	entry->data = data;
+	entry->next_free = -1;
+	map->count++;
+
+	return (entry->generation << SLOTMAP_INDEX_BITS) | index;
+}
+
+/**
+ *  Gets the data referred to by an id.
+ *
+ *  @param map		a slot map
+ *  @param id		an id returned by slotmap_insert()
+ *
+ *  @returns		the data or NULL if the id is invalid or the data has been removed
+ */
+void * slotmap_get(SlotMap *map, int id)
+{
+	SlotMapEntry *entry = _slotmap_get_entry(map, id);
+
+	return (entry) ? entry->data : NULL;
+}
+
+/**
+ *  Calls a function for the data of every occupied slot.
+ *
+ *  @note	The function may remove the data it has been called with.
+ *
+ *  @param map		a slot map
+ *  @param func		the function to call
+ */
+void slotmap_foreach(SlotMap *map, void (*func)(void *data))
+{
+	int i;
+
+	for (i = 0; i < map->length; i++) {
+		if (map->entries[i].data)
+			func(map->entries[i].data);
+	}
+}
+
+// --- Removing ---
+
+/**
+ *  Removes the data referred to by an id and releases its slot. After calling
+ *  this function the id is no longer valid.
+ *
+ *  @param map		a slot map
+ *  @param id		an id returned by slotmap_insert()
+ *
+ *  @returns		the removed data or NULL if the id is invalid or stale
+ */
+void * slotmap_remove(SlotMap *map, int id)
+{
+	SlotMapEntry *entry = _slotmap_get_entry(map, id);
+	void *data;
+
+	if (!entry)
+		return NULL;
+
+	data = entry->data;
+
+	// Invalidate all ids of this slot and put it onto the free list
+	entry->data = NULL;
+	entry->generation = (entry->generation < SLOTMAP_MAX_GENERATION) ? entry->generation + 1 : 1;
+	entry->next_free = map->free_head;
+	map->free_head = entry - map->entries;
+	map->count--;
+
+	return data;
+}
+
+/** @} */
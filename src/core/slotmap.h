@@ -0,0 +1,86 @@
+/*
+ * slotmap.h
+ * This file is part of Arena1
+ *
+ * Copyright (C) 2013
+ *
+ * Arena1 is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Arena1 is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Arena1. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ *  @defgroup slotmap slotmap
+ *  @brief Provides a table which maps generational ids to data.
+ *
+ *  This module provides a table which stores pointers to arbitrary data and hands
+ *  out an integer id for each of them. Looking up data by its id takes constant time.
+ *
+ *  Every slot of the table has a generation counter which is part of the id and which
+ *  is incremented when the slot is released. This way an id which refers to data that
+ *  has already been removed is detected even if its slot has been reused in the meantime.
+ *
+ *  @note	Valid ids are always greater than zero, so 0 may be used as an invalid id.
+ *
+ *  @{
+ */
+
+#ifndef SLOTMAP_H_
+#define SLOTMAP_H_
+
+#define SLOTMAP_INDEX_BITS		16									/**< number of bits of an id used for the slot index */
+#define SLOTMAP_MAX_SLOTS		(1 << SLOTMAP_INDEX_BITS)			/**< maximum number of slots in a slot map */
+#define SLOTMAP_MAX_GENERATION	0x7FFF								/**< maximum generation before it wraps around */
+
+/**
+ *  A slot of a slot map.
+ *
+ *  @private
+ */
+typedef struct {
+	void	*data;			/**< the data stored in this slot or NULL if the slot is free */
+	int		 generation;	/**< current generation of this slot */
+	int		 next_free;		/**< index of the next free slot if this slot is free, otherwise -1 */
+} SlotMapEntry;
+
+/**
+ *  The SlotMap struct holds the slots and the list of free slots.
+ */
+typedef struct {
+	SlotMapEntry	*entries;		/**< array of slots */
+	int				 size;			/**< number of allocated slots */
+	int				 length;		/**< number of slots which have been used at least once */
+	int				 count;			/**< number of slots currently holding data */
+	int				 free_head;		/**< index of the first free slot or -1 */
+} SlotMap;
+
+extern SlotMap * slotmap_new();
+extern void slotmap_free(SlotMap *map);
+
+extern int slotmap_insert(SlotMap *map, void *data);
+extern void * slotmap_get(SlotMap *map, int id);
+extern void * slotmap_remove(SlotMap *map, int id);
+extern void slotmap_foreach(SlotMap *map, void (*func)(void *data));
+
+/**
+ *  A convenience macro to get the number of elements stored in a slot map.
+ *
+ *  @param map		a slot map
+ *
+ *  @returns		the number of elements
+ */
+#define slotmap_count(map)		((map)->count)
+
+#endif /* SLOTMAP_H_ */
+
+/** @} */
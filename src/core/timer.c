@@ -25,149 +25,627 @@
  */
 
 #include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
 #include <SDL/SDL.h>
-#include "list.h"
-#include "event.h"
+#include "common.h"
+#include "slotmap.h"
+#include "hashmap.h"
+#include "ilist.h"
+#include "pool.h"
+#include "group.h"
+#include "clock.h"
 #include "timer.h"
 
 
 
+#define TIMER_TICK_NS			1000000ULL							/**< duration of one tick of the timing wheel in nanoseconds (1 ms) */
+#define TIMER_WHEEL_BITS		6									/**< number of bits of the expiry tick used by each level */
+#define TIMER_WHEEL_SIZE		(1 << TIMER_WHEEL_BITS)				/**< number of slots of each level */
+#define TIMER_WHEEL_MASK		(TIMER_WHEEL_SIZE - 1)				/**< mask to get the slot index */
+#define TIMER_WHEEL_LEVELS		4									/**< number of levels, together they cover 2^24 ticks (4.6 hours) */
+#define TIMER_UNLIMITED_BUDGET_NS	10000000ULL						/**< time spent on the timers of an unlimited clock per call of timer_process() (10 ms) */
+
+/**
+ *  A hierarchical timing wheel. There is one wheel for each clock.
+ */
+typedef struct {
+	IList			 slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SIZE];	/**< a list of tick sources for each slot of each level */
+	Uint64			 tick;			/**< the next tick to be processed, all earlier ticks have been processed */
+	int				 n_scheduled;	/**< number of tick sources in the wheel */
+} TimerWheel;
+
+/**
+ *  A tick source which is shared by all timers with the same interval. Only the tick
+ *  sources are stored in the timing wheel. When a tick source elapses, the handlers
+ *  of its enabled timers are called one after another.
+ */
+typedef struct {
+	Clock			 clock;			/**< clock which drives the timers */
+	int				 interval;		/**< interval of the timers in milliseconds */
+	IList			 timers;		/**< timers with this interval sorted by descending priority */
+	int				 n_enabled;		/**< number of enabled timers, the tick source is only scheduled if there are any */
+	Uint64			 expires;		/**< tick at which the tick source elapses next */
+	IList			*slot;			/**< slot of the timing wheel the tick source is stored in or NULL */
+	ILink			 link;			/**< link in the slot of the timing wheel */
+} TimerSource;
+
 /**
  *  A struct which holds several informations about a timer.
  */
 typedef struct {
 	int 			 id;			/**< id of this timer */
-	SDL_TimerID		 sdl_id;		/**< SDL timer id (used for SDL calls only) */
 	TimerState		 state;			/**< state of this timer */
-	int				 interval;		/**< interval of this timer */
+	int				 group;			/**< group to which this timer belongs to */
+	int				 priority;		/**< priority of this timer within its tick source */
+	Clock			 clock;			/**< clock which drives this timer */
+	TimerPolicy		 policy;		/**< what happens with missed ticks */
+	TimerStats		 stats;			/**< statistics about the deadlines of this timer */
+	bool			 restarted;		/**< whether the timer has been paused since its last call, so the interval isn't measured */
+	int				 interval;		/**< interval of this timer in milliseconds */
 	TimerHandler	 handler;		/**< timer handler function */
 	void			*user_data;		/**< user supplied data which is passed to the timer handler function */
+	TimerSource		*source;		/**< tick source whose list contains this timer */
+	ILink			 link;			/**< link in the list of the tick source */
 } TimerInfo;
 
-static List 	*l_timers = NULL;	/**< list of all existing timers */
-static int 		 next_id = 1;		/**< the id of the next timer created by the timer_create_interval() function */
+static SlotMap	*m_timers = NULL;	/**< map which holds all existing timers by their id */
+static HashMap	*m_sources = NULL;	/**< map which holds the tick sources by their clock and interval */
+
+static TimerWheel a_wheels[CLOCK_COUNT];	/**< the timing wheels of all clocks */
+static int		 current_ticks = 0;	/**< number of ticks passed to the running timer handler (see timer_get_ticks()) */
 
-static int 		 evt_sdl_user;		/**< id of the sdl-user event handler */
+static void _timer_release(ILink *link);
 
 // --- Static Functions -------------------------------------------------------
 
 /**
- *  The callback function for all SDL timers. It pushes an SDL event
- *  so that the timer can be handled in the main thread.
+ *  Gets the current tick of a clock.
  *
- *  @note	This function isn't called in the main thread!
+ *  @param clock	a clock
  *
- *  @param interval		interval of the timer
- *  @param param		in our case this is a pointer to the TimerInfo struct of the timer
+ *  @returns		the current tick
+ */
+static Uint64 _timer_now(Clock clock)
+{
+	return clock_get_ns(clock) / TIMER_TICK_NS;
+}
+
+/**
+ *  Gets the TimerInfo of a specified timer.
  *
- *  @returns			The new interval, this is the interval stored in the TimerInfo struct. Mostly, it will remain the same.
+ *  @param id		id of the timer
+ *
+ *  @returns		the TimerInfo or NULL if the id is invalid or stale.
  */
-static Uint32 _timer_thread_swap(Uint32 interval, void *param)
+static TimerInfo * _timer_get(int id)
 {
-	SDL_Event event;
-	TimerInfo *timer;
+	return (TimerInfo *)slotmap_get(m_timers, id);
+}
 
-	timer = (TimerInfo *)param;
+/**
+ *  Gets the interval of a tick source in ticks of the timing wheel.
+ *
+ *  @param source	a tick source
+ *
+ *  @returns		the interval, at least one tick
+ */
+static Uint64 _timer_source_get_ticks(TimerSource *source)
+{
+	return (source->interval > 0) ? source->interval : 1;
+}
 
-	event.user.type = SDL_USEREVENT;
-	event.user.code = 1;
-	event.user.data1 = timer;
-	event.user.data2 = NULL;
+/**
+ *  Inserts a tick source into the slot of the timing wheel which matches its expiry tick.
+ *  Tick sources which elapse within the next TIMER_WHEEL_SIZE ticks are stored in the first
+ *  level, the others in one of the coarser levels. They are moved down (cascaded) when their
+ *  slot is reached.
+ *
+ *  @param source	a tick source, which mustn't be in the wheel
+ */
+static void _timer_schedule(TimerSource *source)
+{
+	TimerWheel *wheel = &a_wheels[source->clock];
+	Uint64 expires, delta;
+	int level;
+
+	// A tick source can't elapse in the past
+	if (source->expires < wheel->tick)
+		source->expires = wheel->tick;
+
+	// Find the level which covers the remaining time. Tick sources beyond the last
+	// level are put into its farthest slot and rescheduled when it is reached.
+	expires = source->expires;
+	delta = expires - wheel->tick;
+
+	for (level = 0; level < TIMER_WHEEL_LEVELS - 1; level++) {
+		if (delta < (1ULL << (TIMER_WHEEL_BITS * (level + 1))))
+			break;
+	}
 
-	SDL_PushEvent(&event);
+	if (delta >= (1ULL << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS)))
+		expires = wheel->tick + (1ULL << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS)) - 1;
 
-	return timer->interval;
+	source->slot = &wheel->slots[level][(expires >> (TIMER_WHEEL_BITS * level)) & TIMER_WHEEL_MASK];
+	ilist_append(source->slot, &source->link);
+	wheel->n_scheduled++;
 }
 
 /**
- *  Gets the list element in the l_timers list which holds the TimerInfo of a specified timer.
+ *  Removes a tick source from the timing wheel.
  *
- *  @param id		id of the timer
+ *  @param source	a tick source
+ */
+static void _timer_unschedule(TimerSource *source)
+{
+	if (!source->slot)
+		return;
+
+	ilist_remove(source->slot, &source->link);
+	source->slot = NULL;
+	a_wheels[source->clock].n_scheduled--;
+}
+
+/**
+ *  Gets the key of the tick source for a specified clock and interval in the map of tick sources.
+ *
+ *  @param clock		a clock
+ *  @param interval		interval in milliseconds
  *
- *  @returns		the list element or NULL if it couldn't be found.
+ *  @returns			the key
  */
-static List * _timer_get_link(int id)
+static intptr_t _timer_get_source_key(Clock clock, int interval)
 {
-	List *link;
-	TimerInfo *timer;
+	return (intptr_t)interval * CLOCK_COUNT + clock;
+}
+
+/**
+ *  Gets the tick source for a specified clock and interval. The tick source is created if it doesn't exist.
+ *
+ *  @param clock		a clock
+ *  @param interval		interval in milliseconds
+ *
+ *  @returns			the tick source
+ */
+static TimerSource * _timer_get_source(Clock clock, int interval)
+{
+	TimerSource *source;
+	intptr_t key = _timer_get_source_key(clock, interval);
+
+	source = (TimerSource *)hashmap_lookup_int(m_sources, key);
+	if (source)
+		return source;
+
+	source = (TimerSource *)pool_alloc(sizeof(TimerSource));
+	source->clock = clock;
+	source->interval = interval;
+	ilist_init(&source->timers, _timer_release);
+	source->n_enabled = 0;
+	source->expires = 0;
+	source->slot = NULL;
+	hashmap_insert_int(m_sources, key, source);
+
+	return source;
+}
+
+/**
+ *  Counts an enabled timer of a tick source. The first enabled timer starts the tick source,
+ *  the following ones are fired in the phase of the running tick source.
+ *
+ *  @param source	a tick source
+ */
+static void _timer_source_enable(TimerSource *source)
+{
+	if (source->n_enabled++ > 0 || source->slot)
+		return;
+
+	source->expires = _timer_now(source->clock) + _timer_source_get_ticks(source);
+	_timer_schedule(source);
+}
+
+/**
+ *  Uncounts an enabled timer of a tick source. The tick source is stopped if
+ *  none of its timers is enabled anymore.
+ *
+ *  @param source	a tick source
+ */
+static void _timer_source_disable(TimerSource *source)
+{
+	if (--source->n_enabled > 0)
+		return;
+
+	_timer_unschedule(source);
+}
+
+/**
+ *  Frees a tick source if it has no timers anymore. A tick source which is firing right
+ *  now is kept, _timer_fire() calls this function again when it is done.
+ *
+ *  @param source	a tick source
+ *
+ *  @returns		TRUE, if the tick source has been freed.
+ */
+static bool _timer_source_release(TimerSource *source)
+{
+	if (ilist_first(&source->timers) || source->timers.walking)
+		return FALSE;
+
+	hashmap_remove_int(m_sources, _timer_get_source_key(source->clock, source->interval));
+	_timer_unschedule(source);
+	pool_free(source, sizeof(TimerSource));
+
+	return TRUE;
+}
 
-	// Iterate through all timers
-	link = list_first(l_timers);
-	while (link) {
-		timer = (TimerInfo *)link->data;
+/**
+ *  Adds a timer to the tick source matching its clock and interval. The timer is inserted in front
+ *  of the timers with a lower or equal priority, so timers with a higher priority are fired first.
+ *
+ *  @param timer	TimerInfo of the timer, which mustn't belong to a tick source
+ */
+static void _timer_attach(TimerInfo *timer)
+{
+	TimerSource *source;
+	ILink *link;
 
-		// Is this the timer we are looking for? If yes, return the link.
-		if (timer->id == id)
-			return link;
+	source = _timer_get_source(timer->clock, timer->interval);
 
-		link = list_next(link);
+	// Find the first timer with a lower or equal priority
+	for (link = source->timers.head; link; link = link->next) {
+		if (!link->removed && ilist_entry(link, TimerInfo, link)->priority <= timer->priority)
+			break;
 	}
 
-	// We couldn't find it
-	return link;
+	ilist_insert_before(&source->timers, link, &timer->link);
+	timer->source = source;
+
+	if (timer->state == TIMER_ENABLED)
+		_timer_source_enable(source);
 }
 
 /**
- *  Gets the TimerInfo of a specified timer stored in the l_timers list.
+ *  Removes a timer from its tick source. If the tick source is firing right now, the timer
+ *  stays linked until all timers have been fired. Afterwards _timer_release() either attaches
+ *  the timer to the tick source matching its (new) clock and interval or frees it. A tick
+ *  source without any timers is freed.
  *
- *  @param id		id of the event
+ *  @param timer	TimerInfo of the timer
+ */
+static void _timer_detach(TimerInfo *timer)
+{
+	TimerSource *source = timer->source;
+
+	// Has it already been detached?
+	if (timer->link.removed)
+		return;
+
+	if (timer->state == TIMER_ENABLED)
+		_timer_source_disable(source);
+
+	// The timer may be released and even freed immediately
+	ilist_remove(&source->timers, &timer->link);
+	_timer_source_release(source);
+}
+
+/**
+ *  Called when a timer has been unlinked from the list of its tick source.
  *
- *  @returns		the TimerInfo or NULL if it couldn't be found.
+ *  @param link		link of the timer
  */
-static TimerInfo * _timer_get(int id)
+static void _timer_release(ILink *link)
 {
-	List *link;
+	TimerInfo *timer = ilist_entry(link, TimerInfo, link);
 
-	// Use function to get the link and return its data.
-	link = _timer_get_link(id);
-	return (link) ? (TimerInfo *)link->data : NULL;
+	timer->source = NULL;
+
+	// Free the timer if it has been freed by timer_free(), otherwise it has been detached
+	// to change its clock, interval or priority.
+	if (_timer_get(timer->id) != timer)
+		pool_free(timer, sizeof(TimerInfo));
+	else
+		_timer_attach(timer);
 }
 
 /**
- *  Sets a new state for a specified timer. If this is enabling
- *  the timer, an SDL timer is created and started. If this is
- *  disabling the timer, the SDL timer is removed.
+ *  Sets a new state for a specified timer. If this is enabling the timer and its tick
+ *  source isn't running yet, the tick source is started and elapses after one interval.
+ *  If this is disabling the last enabled timer, the tick source is stopped.
  *
  *  @param timer	TimerInfo of the timer beeing changed
  *  @param state	the new state of the timer
  */
 static void _timer_set_state(TimerInfo *timer, TimerState state)
 {
-	// Do we have to enable the timer?
-	if (timer->state == TIMER_DISABLED && state == TIMER_ENABLED) {
-		timer->sdl_id = SDL_AddTimer(timer->interval, _timer_thread_swap, timer);
-		timer->state = TIMER_ENABLED;
+	if (timer->state == state)
+		return;
+
+	timer->state = state;
+	timer->restarted = TRUE;
+
+	// A detached timer is counted when it is attached again
+	if (timer->link.removed)
+		return;
+
+	if (state == TIMER_ENABLED)
+		_timer_source_enable(timer->source);
+	else
+		_timer_source_disable(timer->source);
+}
+
+/**
+ *  Calls the handler of a timer during a pass through an elapsed tick source. In the first
+ *  pass every enabled timer is called, in the following passes only the timers which
+ *  catch up missed ticks. The handler isn't called if the group of the timer is inactive.
+ *
+ *  @param timer	TimerInfo of the timer
+ *  @param pass		number of the pass, starting with 0
+ *  @param ticks	number of ticks which have elapsed
+ *  @param passes	number of passes
+ *  @param deadline	time of the clock at which the tick source should have elapsed in nanoseconds
+ *  @param now		time of the clock at which the tick source actually elapsed in nanoseconds
+ */
+static void _timer_call(TimerInfo *timer, int pass, int ticks, int passes, Uint64 deadline, Uint64 now)
+{
+	int prev_ticks;
+
+	if (timer->state != TIMER_ENABLED)
+		return;
+
+	if (!group_is_active(timer->group)) {
+		timer->restarted = TRUE;
+		return;
 	}
 
-	// Do we have to disable the timer?
-	if (timer->state == TIMER_ENABLED && state == TIMER_DISABLED) {
-		SDL_RemoveTimer(timer->sdl_id);
-		timer->sdl_id = 0;
-		timer->state = TIMER_DISABLED;
+	if (pass == 0) {
+		histogram_add(&timer->stats.lateness, (now > deadline) ? now - deadline : 0);
+		if (!timer->restarted)
+			histogram_add(&timer->stats.interval, now - timer->stats.fired_at);
+
+		timer->restarted = FALSE;
+		timer->stats.deadline = deadline;
+		timer->stats.fired_at = now;
+		if (ticks > 1)
+			timer->stats.late++;
+
+		// Count the missed ticks which won't be made up
+		if (timer->policy == TIMER_POLICY_SKIP)
+			timer->stats.lost += ticks - 1;
+		else if (timer->policy == TIMER_POLICY_CATCH_UP)
+			timer->stats.lost += ticks - passes;
+	} else {
+		if (timer->policy != TIMER_POLICY_CATCH_UP)
+			return;
+
+		timer->stats.caught_up++;
 	}
+
+	timer->stats.fired++;
+
+	prev_ticks = current_ticks;
+	current_ticks = (timer->policy == TIMER_POLICY_TICKS) ? ticks : 1;
+	timer->handler(timer->user_data);
+	current_ticks = prev_ticks;
 }
 
 /**
- *  Event handler function for the "sdl-user" event. This event handler is called
- *  if a timer has elapsed. It gets information about the elapsed timer and calls
- *  it's timer handler function.
+ *  Calls the timer handler functions of the enabled timers of an elapsed tick source
+ *  and schedules the tick source again.
  *
- *  @param event_data	the TimerInfo struct of the timer
- *  @param user_data	NULL
+ *  If the tick source has missed ticks, the timers which catch up are called again in
+ *  additional passes, so the relative order of the timers is kept for every tick.
+ *
+ *  @param source	a tick source, which has already been removed from the wheel
+ *  @param now		the current tick
  */
-static void _timer_evt_sdl_user(void *event_data, void *user_data)
+static void _timer_fire(TimerSource *source, Uint64 now)
 {
-	SDL_UserEvent *event = (SDL_UserEvent *)event_data;
 	TimerInfo *timer;
+	IListIter iter;
+	ILink *link;
+	Uint64 deadline, now_ns, interval;
+	int ticks, passes, pass;
+
+	// Count the ticks which have elapsed since the planned expiry
+	interval = _timer_source_get_ticks(source);
+	ticks = (now - source->expires) / interval + 1;
+	passes = (ticks < TIMER_MAX_CATCH_UP) ? ticks : TIMER_MAX_CATCH_UP;
+	deadline = source->expires * TIMER_TICK_NS;
+	now_ns = clock_get_ns(source->clock);
+
+	// Timers created or attached in the meantime aren't fired before the next tick
+	link = ilist_begin(&source->timers, &iter);
+	for (pass = 0; pass < passes; pass++) {
+		if (pass > 0)
+			link = ilist_iter_first(&iter);
+
+		while (link) {
+			timer = ilist_entry(link, TimerInfo, link);
+			_timer_call(timer, pass, ticks, passes, deadline, now_ns);
+			link = ilist_iter_next(&iter, link);
+		}
+	}
+	ilist_end(&iter);
+
+	// All timers may have been freed or moved to other tick sources meanwhile
+	if (_timer_source_release(source))
+		return;
 
-	// If the event has the right code we call the
-	// function which handles the elapsed timer.
-	if (event->code == 1) {
-		timer = (TimerInfo *)event->data1;
-		timer->handler(timer->user_data);
+	// The timers may have been disabled or even enabled again by their handlers
+	if (!source->n_enabled || source->slot)
+		return;
+
+	// Keep the period relative to the planned expiry, so that the tick source doesn't drift
+	source->expires += ticks * interval;
+	_timer_schedule(source);
+}
+
+/**
+ *  Processes one tick of the timing wheel: cascades the coarser levels if a
+ *  slot of them has been reached and fires all tick sources of the current slot.
+ *
+ *  @param wheel	a timing wheel
+ *  @param now		the current tick
+ */
+static void _timer_process_tick(TimerWheel *wheel, Uint64 now)
+{
+	TimerSource *source;
+	IList *slot;
+	ILink *link;
+	int level, index;
+
+	// Move the tick sources of the coarser levels down, level by level, as long as
+	// the index of the finer level has wrapped around.
+	for (level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+		if ((wheel->tick >> (TIMER_WHEEL_BITS * (level - 1))) & TIMER_WHEEL_MASK)
+			break;
+
+		index = (wheel->tick >> (TIMER_WHEEL_BITS * level)) & TIMER_WHEEL_MASK;
+		slot = &wheel->slots[level][index];
+
+		while ((link = ilist_first(slot))) {
+			source = ilist_entry(link, TimerSource, link);
+			_timer_unschedule(source);
+			_timer_schedule(source);
+		}
+	}
+
+	// Fire all tick sources of the current slot. Each one is removed before it is fired,
+	// so the timer handlers may change any timer. Rescheduled tick sources always elapse later.
+	slot = &wheel->slots[0][wheel->tick & TIMER_WHEEL_MASK];
+
+	while ((link = ilist_first(slot))) {
+		source = ilist_entry(link, TimerSource, link);
+		_timer_unschedule(source);
+		_timer_fire(source, now);
+	}
+}
+
+/**
+ *  Processes all ticks of the timing wheel of a clock up to a specified tick.
+ *
+ *  @param clock	a clock
+ *  @param now		the current tick of the clock
+ */
+static void _timer_process_wheel(Clock clock, Uint64 now)
+{
+	TimerWheel *wheel = &a_wheels[clock];
+
+	// If there is no timer at all, the wheel can simply jump to the current tick
+	if (!wheel->n_scheduled && wheel->tick <= now) {
+		wheel->tick = now + 1;
+		return;
+	}
+
+	while (wheel->tick <= now) {
+		_timer_process_tick(wheel, now);
+		wheel->tick++;
+	}
+}
+
+/**
+ *  Gets the next tick of a timing wheel which has to be processed. This may be earlier
+ *  than the next expiry, if the timing wheel has to cascade tick sources.
+ *
+ *  @param wheel	a timing wheel, which mustn't be empty
+ *
+ *  @returns		the tick
+ */
+static Uint64 _timer_get_next_tick(TimerWheel *wheel)
+{
+	Uint64 tick;
+
+	// Search the first level for the next tick source up to the point where
+	// the coarser levels have to be cascaded.
+	for (tick = wheel->tick; ; tick++) {
+		if (ilist_length(&wheel->slots[0][tick & TIMER_WHEEL_MASK]) > 0)
+			break;
+		if (tick != wheel->tick && (tick & TIMER_WHEEL_MASK) == 0)
+			break;
+	}
+
+	return tick;
+}
+
+/**
+ *  Processes the timing wheel of an unlimited clock. The clock jumps from one expiry to
+ *  the next until there are no more timers or TIMER_UNLIMITED_BUDGET_NS have been spent,
+ *  so the main loop still gets the chance to process events and to draw.
+ *
+ *  @param clock	an unlimited clock
+ */
+static void _timer_process_unlimited(Clock clock)
+{
+	TimerWheel *wheel = &a_wheels[clock];
+	Uint64 end = time_get_ns() + TIMER_UNLIMITED_BUDGET_NS;
+	Uint64 tick;
+
+	while (wheel->n_scheduled && clock_is_unlimited(clock) && time_get_ns() < end) {
+		tick = _timer_get_next_tick(wheel);
+		clock_advance(clock, tick * TIMER_TICK_NS);
+		_timer_process_wheel(clock, tick);
 	}
 }
 
+/**
+ *  Disables and frees a timer. Used by timer_destroy() to free all timers.
+ *
+ *  @param data		TimerInfo of the timer
+ */
+static void _timer_free(void *data)
+{
+	TimerInfo *timer = (TimerInfo *)data;
+
+	// The timer is freed by _timer_release() as soon as it is unlinked
+	slotmap_remove(m_timers, timer->id);
+	_timer_detach(timer);
+}
+
+/**
+ *  Prints the statistics of a timer. Used by timer_print_stats().
+ *
+ *  @param data		TimerInfo of the timer
+ */
+static void _timer_print_stats(void *data)
+{
+	TimerInfo *timer = (TimerInfo *)data;
+
+	printf("-> id: %6d  clock: %d  interval: %5dms  priority: %2d  policy: %d  group: %2d  handler: %p\n",
+			timer->id,
+			timer->clock,
+			timer->interval,
+			timer->priority,
+			timer->policy,
+			timer->group,
+			timer->handler);
+	printf("   fired: %llu  late: %llu  caught up: %llu  lost: %llu\n",
+			(unsigned long long)timer->stats.fired,
+			(unsigned long long)timer->stats.late,
+			(unsigned long long)timer->stats.caught_up,
+			(unsigned long long)timer->stats.lost);
+
+	if (timer->stats.fired == 0)
+		return;
+
+	printf("   lateness: ");
+	histogram_print(&timer->stats.lateness);
+	printf("   interval: ");
+	histogram_print(&timer->stats.interval);
+}
+
+/**
+ *  Frees a tick source. Used by timer_destroy() after all timers have been freed.
+ *
+ *  @param data		a tick source
+ */
+static void _timer_free_source(void *data)
+{
+	TimerSource *source = (TimerSource *)data;
+
+	_timer_unschedule(source);
+	pool_free(source, sizeof(TimerSource));
+}
+
 // --- Public Functions -------------------------------------------------------
 
 /**
@@ -175,8 +653,22 @@ static void _timer_evt_sdl_user(void *event_data, void *user_data)
  */
 void timer_init()
 {
-	// Register events
-	evt_sdl_user = event_connect("sdl-user", 0, _timer_evt_sdl_user, NULL, EVENT_HANDLER_ENABLED);
+	int clock, level, index;
+
+	// Create the maps for the timers and the tick sources
+	m_timers = slotmap_new();
+	m_sources = hashmap_new_int();
+
+	// Initialize the timing wheels
+	for (clock = 0; clock < CLOCK_COUNT; clock++) {
+		for (level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+			for (index = 0; index < TIMER_WHEEL_SIZE; index++)
+				ilist_init(&a_wheels[clock].slots[level][index], NULL);
+		}
+
+		a_wheels[clock].tick = _timer_now(clock);
+		a_wheels[clock].n_scheduled = 0;
+	}
 }
 
 /**
@@ -184,34 +676,74 @@ void timer_init()
  */
 void timer_destroy()
 {
-	List *link;
-	TimerInfo *timer;
+	// Disable and free all timers
+	slotmap_foreach(m_timers, _timer_free);
 
-	// Unregister events
-	event_disconnect(evt_sdl_user);
+	// Release resources
+	hashmap_foreach(m_sources, _timer_free_source);
+	hashmap_free(m_sources);
+	m_sources = NULL;
+	slotmap_free(m_timers);
+	m_timers = NULL;
+}
+
+/**
+ *  Calls the timer handler functions of all timers which have elapsed since the last call.
+ *  If a timer has elapsed several times, this depends on its policy (see timer_set_policy()).
+ *  Timers of paused clocks don't elapse. Timers of unlimited clocks are processed as
+ *  fast as possible for a limited time.
+ *
+ *  @note	This function should be called by the main loop as often as possible, at least
+ *  		when the time returned by timer_get_next_expiry() has been reached.
+ */
+void timer_process()
+{
+	int clock;
+
+	for (clock = 0; clock < CLOCK_COUNT; clock++) {
+		if (clock_is_unlimited(clock))
+			_timer_process_unlimited(clock);
+		else if (!clock_is_paused(clock))
+			_timer_process_wheel(clock, _timer_now(clock));
+	}
+}
 
-	// Iterate through all timers
-	link = list_first(l_timers);
-	while (link) {
-		timer = (TimerInfo *)link->data;
+/**
+ *  Gets the time at which timer_process() has to be called next. This may be
+ *  earlier than the next expiry, if the timing wheel has to cascade timers.
+ *
+ *  @returns		the time in nanoseconds (see time_get_ns()) or 0 if no timer is enabled
+ */
+Uint64 timer_get_next_expiry()
+{
+	Uint64 next = 0, ns;
+	int clock;
 
-		// Disable all timers
-		_timer_set_state(timer, TIMER_DISABLED);
+	for (clock = 0; clock < CLOCK_COUNT; clock++) {
+		if (!a_wheels[clock].n_scheduled || clock_is_paused(clock))
+			continue;
 
-		link = list_next(link);
+		// Convert the time of the clock into real time
+		ns = clock_get_real_ns(clock, _timer_get_next_tick(&a_wheels[clock]) * TIMER_TICK_NS);
+		if (ns && (!next || ns < next))
+			next = ns;
 	}
 
-	// Release resources
-	list_free_full(l_timers, free);
+	return next;
 }
 
 /**
  *  Creates a new timer.
  *
+ *  Timers with the same interval share a tick source, so they elapse at the same time. Their
+ *  handlers are called one after another in the order of their priority (see timer_set_priority()).
+ *  A timer which is enabled while other timers with the same interval are running elapses
+ *  together with them, so the first interval may be shorter.
+ *
  *  @attention	Under no circumstances the timer handler function should block for a long time because no other events
  *  			can be processed as long as an timer handler is running!
  *
- *  @param interval		interval of the timer
+ *  @param interval		interval of the timer in milliseconds
  *  @param handler		the timer handler function which will be called everytime the timer elapses
  *  @param user_data	data which will be passed to the timer handler function everytime the timer elapses
  *  @param state		the initial state of the timer
@@ -223,18 +755,22 @@ int timer_create_interval(int interval, TimerHandler handler, void *user_data, T
 	TimerInfo *timer;
 
 	// Create a new struct containing informations about the timer
-	timer = (TimerInfo *)malloc(sizeof(TimerInfo));
-	timer->id = next_id++;
-	timer->sdl_id = 0;
-	timer->state = TIMER_DISABLED;
+	timer = (TimerInfo *)pool_alloc(sizeof(TimerInfo));
+	timer->id = slotmap_insert(m_timers, timer);
+	timer->state = state;
+	timer->group = GROUP_DEFAULT;
+	timer->priority = 0;
+	timer->clock = CLOCK_REAL;
+	timer->policy = TIMER_POLICY_SKIP;
+	memset(&timer->stats, 0, sizeof(TimerStats));
+	timer->restarted = TRUE;
 	timer->interval = interval;
 	timer->handler = handler;
 	timer->user_data = user_data;
+	timer->source = NULL;
 
-	l_timers = list_append(l_timers, timer);
-
-	// Apply the initial state
-	_timer_set_state(timer, state);
+	// Add it to its tick source, which starts it if it is enabled
+	_timer_attach(timer);
 
 	return timer->id;
 }
@@ -260,7 +796,28 @@ void timer_set_state(int id, TimerState state)
 }
 
 /**
- *  Sets a new interval for an existing timer.
+ *  Moves a timer into a group. The timer only fires while its group is active
+ *  (see group_set_state()). If there is no timer with the given id, this function does nothing.
+ *
+ *  @param id		id of the timer
+ *  @param group	id of the group as returned by group_register()
+ */
+void timer_set_group(int id, int group)
+{
+	TimerInfo *timer;
+
+	// Get the timer information
+	timer = _timer_get(id);
+	if (!timer)
+		return;
+
+	// Set the group
+	timer->group = group;
+}
+
+/**
+ *  Sets a new interval for an existing timer. The timer joins the timers with the
+ *  new interval and elapses together with them from now on.
  *  If there is no timer with the given id, this function does nothing.
  *
  *  @param id			id of the timer
@@ -275,8 +832,130 @@ void timer_set_interval(int id, int interval)
 	if (!timer)
 		return;
 
-	// Set the interval
+	if (timer->interval == interval)
+		return;
+
+	// Set the interval and move the timer to the matching tick source
 	timer->interval = interval;
+	_timer_detach(timer);
+}
+
+/**
+ *  Sets the clock which drives a timer. The timer joins the timers with the same
+ *  interval of the new clock and elapses together with them from now on.
+ *  If there is no timer with the given id, this function does nothing.
+ *
+ *  @param id		id of the timer
+ *  @param clock	a clock
+ */
+void timer_set_clock(int id, Clock clock)
+{
+	TimerInfo *timer;
+
+	// Get the timer information
+	timer = _timer_get(id);
+	if (!timer || timer->clock == clock)
+		return;
+
+	// Set the clock and move the timer to the matching tick source
+	timer->clock = clock;
+	_timer_detach(timer);
+}
+
+/**
+ *  Sets the priority of a timer. Timers which elapse at the same time because they have
+ *  the same interval are fired in the order of their priority, the timers with the
+ *  highest priority values first. Timers with the same priority are fired in the reverse
+ *  order in which they have got it. The default priority is 0.
+ *  If there is no timer with the given id, this function does nothing.
+ *
+ *  @param id			id of the timer
+ *  @param priority		a priority value
+ */
+void timer_set_priority(int id, int priority)
+{
+	TimerInfo *timer;
+
+	// Get the timer information
+	timer = _timer_get(id);
+	if (!timer)
+		return;
+
+	// Set the priority and insert the timer again at the matching position
+	timer->priority = priority;
+	_timer_detach(timer);
+}
+
+/**
+ *  Sets what happens with the ticks a timer has missed because the main loop was late.
+ *  If there is no timer with the given id, this function does nothing.
+ *
+ *  @param id			id of the timer
+ *  @param policy		the new policy of the timer
+ */
+void timer_set_policy(int id, TimerPolicy policy)
+{
+	TimerInfo *timer;
+
+	// Get the timer information
+	timer = _timer_get(id);
+	if (!timer)
+		return;
+
+	// Set the policy
+	timer->policy = policy;
+}
+
+/**
+ *  Gets the number of ticks which have elapsed for the running timer handler. This is
+ *  only more than 1 if the timer has the policy TIMER_POLICY_TICKS and has missed ticks.
+ *
+ *  @returns		the number of ticks or 0 if no timer handler is running
+ */
+int timer_get_ticks()
+{
+	return current_ticks;
+}
+
+/**
+ *  Gets the time at which a timer elapses next.
+ *
+ *  @param id		id of the timer
+ *
+ *  @returns		the time of the clock of the timer in nanoseconds or 0 if the timer is
+ *  				disabled or the id is invalid
+ */
+Uint64 timer_get_next_deadline(int id)
+{
+	TimerInfo *timer;
+
+	// Get the timer information
+	timer = _timer_get(id);
+	if (!timer || timer->state != TIMER_ENABLED || !timer->source || !timer->source->slot)
+		return 0;
+
+	return timer->source->expires * TIMER_TICK_NS;
+}
+
+/**
+ *  Gets the statistics about the deadlines of a timer.
+ *
+ *  @attention	The returned statistics belong to the timer, don't modify them!
+ *
+ *  @param id		id of the timer
+ *
+ *  @returns		the statistics or NULL if the id is invalid
+ */
+TimerStats * timer_get_stats(int id)
+{
+	TimerInfo *timer;
+
+	// Get the timer information
+	timer = _timer_get(id);
+	if (!timer)
+		return NULL;
+
+	return &timer->stats;
 }
 
 /**
@@ -309,21 +988,24 @@ void timer_set_user_data(int id, void* user_data)
  */
 void timer_free(int id)
 {
-	List *link;
 	TimerInfo *timer;
 
 	// Try to find the appropriate timer
-	link = _timer_get_link(id);
-	if (link) {
-		timer = (TimerInfo *)link->data;
-
-		// Disable it...
-		_timer_set_state(timer, TIMER_DISABLED);
-
-		// ...and free it
-		free(timer);
-		l_timers = list_delete_link(l_timers, link);
+	timer = _timer_get(id);
+	if (timer) {
+		// Free it, which also disables it
+		_timer_free(timer);
 	}
 }
 
+/**
+ *  Prints the statistics of all timers: the number of calls, late calls, made up and lost
+ *  ticks and the distributions of the lateness and of the interval between two calls.
+ */
+void timer_print_stats()
+{
+	printf("timers (%d tick sources)\n", hashmap_count(m_sources));
+	slotmap_foreach(m_timers, _timer_print_stats);
+}
+
 /** @} */
@@ -23,12 +23,34 @@
  *  @defgroup timer timer
  *  @brief Simplifies the use of timers provided by the SDL library.
  *
- *  This module simplifies the use of the timers provided by the SDL
- *  library. It's main purpose is to ensure that the handler functions
- *  of the timers are called in the main thread. This is done by
- *  pushing an SDL user event if a timer has elapsed. This causes the main
- *  function to raise a normal event ("sdl-user") which is processed by
- *  this module directing the call to the timer handler function.
+ *  This module provides timers whose handler functions are called in the
+ *  main thread. All timers are kept in a hierarchical timing wheel, so creating,
+ *  enabling and disabling a timer as well as firing an elapsed timer costs constant
+ *  time regardless of the number of timers. The wheel is driven by the monotonic
+ *  clock (see time_get_ns()) with a resolution of one millisecond.
+ *
+ *  The main loop must call timer_process() regularly. It can use
+ *  timer_get_next_expiry() to find out how long it may sleep.
+ *
+ *  Every timer is driven by a clock (see the clock module), by default the real clock.
+ *  Timers of the simulation should use the game clock instead, so they are paused and
+ *  scaled together with it. There is a separate timing wheel for each clock.
+ *
+ *  Timers with the same interval are coalesced into one tick source, which is the
+ *  entry in the timing wheel. When it elapses, the handlers of its timers are called
+ *  in the order of their priority (see timer_set_priority()), so the relative order of
+ *  timers which elapse together is deterministic.
+ *
+ *  A periodic timer is rescheduled relative to its planned expiry instead of the
+ *  time it has actually been fired, so it doesn't drift. If the main loop is late
+ *  by one or more intervals, the missed ticks are handled according to the policy
+ *  of each timer (see TimerPolicy and timer_set_policy()). The ticks fired, made up
+ *  and lost are counted per timer and can be queried by timer_get_stats(). Histograms
+ *  of the lateness and of the interval between two calls show how regular a timer
+ *  is actually fired. They are printed by timer_print_stats().
+ *
+ *  Like event handlers, timers belong to a group and only fire while their group
+ *  is active (see the group module).
  *
  *  @{
  */
@@ -36,6 +58,10 @@
 #ifndef TIMER_H_
 #define TIMER_H_
 
+#include "common.h"
+#include "histogram.h"
+#include "clock.h"
+
 /**
  *  Prototype for a timer handler function.
  *
@@ -51,12 +77,48 @@ typedef enum {
 	TIMER_ENABLED  = 0x01,		/**< the timer is enabled and currently running. */
 } TimerState;
 
+/**
+ *  What happens with the ticks a timer has missed because the main loop was late.
+ */
+typedef enum {
+	TIMER_POLICY_SKIP     = 0x00,	/**< the timer handler is called once, the missed ticks are counted as lost. This is the default. */
+	TIMER_POLICY_CATCH_UP = 0x01,	/**< the timer handler is called once for every missed tick, up to TIMER_MAX_CATCH_UP times. */
+	TIMER_POLICY_TICKS    = 0x02,	/**< the timer handler is called once and gets the number of elapsed ticks by timer_get_ticks(). */
+} TimerPolicy;
+
+/**
+ *  Statistics about the deadlines of a timer.
+ */
+typedef struct {
+	Uint64		fired;			/**< number of calls of the timer handler */
+	Uint64		late;			/**< number of times the timer has been fired after it has missed at least one tick */
+	Uint64		caught_up;		/**< number of missed ticks which have been made up by additional calls */
+	Uint64		lost;			/**< number of missed ticks which have been skipped */
+	Uint64		deadline;		/**< time of its clock at which the timer should have been fired the last time in nanoseconds */
+	Uint64		fired_at;		/**< time of its clock at which the timer has actually been fired the last time in nanoseconds */
+	Histogram	lateness;		/**< distribution of the time between the deadline and the actual call */
+	Histogram	interval;		/**< distribution of the time between two consecutive calls */
+} TimerStats;
+
+#define TIMER_MAX_CATCH_UP		5		/**< maximal number of calls of a timer handler with the policy TIMER_POLICY_CATCH_UP in one tick */
+
 extern void timer_init();
 extern void timer_destroy();
 
+extern void timer_process();
+extern Uint64 timer_get_next_expiry();
+
 extern int timer_create_interval(int interval, TimerHandler handler, void *user_data, TimerState state);
 extern void timer_set_state(int id, TimerState state);
+extern void timer_set_group(int id, int group);
 extern void timer_set_interval(int id, int interval);
+extern void timer_set_clock(int id, Clock clock);
+extern void timer_set_priority(int id, int priority);
+extern void timer_set_policy(int id, TimerPolicy policy);
+extern int timer_get_ticks();
+extern Uint64 timer_get_next_deadline(int id);
+extern TimerStats * timer_get_stats(int id);
+extern void timer_print_stats();
 extern void timer_set_user_data(int id, void* user_data);
 extern void timer_free(int id);
 
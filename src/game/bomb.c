@@ -46,7 +46,7 @@ typedef struct {
 	int sprite;									/**< sprite currently used */
 } BombObject;
 
-static List 		*l_bombs = NULL;			/**< list of all existing bomb objects */
+static IList 		 l_bombs;						/**< list of all existing bomb objects */
 
 static SDL_Surface	*s_bomb;					/**< sprites for the explosion */
 static SDL_Rect		 s_bomb_clips[3];			/**< clips for the sprites */
@@ -55,7 +55,25 @@ static Mix_Chunk	*a_drop;					/**< audio sample when droping a bomb */
 
 static int		 	 evt_gfx_draw;				/**< id of the gfx-draw event handler */
 static int			 evt_explosion_hit;			/**< id of the evt-explosion-hit event handler */
-static int		 	 tmr_step;					/**< id of the step timer */
+static int			 ev_bomb_explode;			/**< id of the bomb-explode event */
+static int		 	 evt_sim_step;				/**< id of the sim-step event handler */
+
+/**
+ *  Lets a bomb explode: raises the bomb-explode event, frees the bomb and creates
+ *  the explosion.
+ *
+ *  @param bomb			a bomb object
+ *  @param playsound	whether to play the explosion sample
+ */
+static void _bomb_explode(BombObject *bomb, bool playsound)
+{
+	Vector pos = bomb->base.pos;
+	ExplosionInfo *exp_info = bomb->exp_info;
+
+	event_raise_id(ev_bomb_explode, bomb);
+	bomb_free((GameObject *)bomb);
+	explosion_create(pos, exp_info, playsound);
+}
 
 /**
  *  Event handler for the gfx-draw event.
@@ -64,11 +82,11 @@ static int		 	 tmr_step;					/**< id of the step timer */
 static void _bomb_evt_gfx_draw(void *event_data, void *user_data)
 {
 	// Loop through all bomb objects
-	List *link = list_first(l_bombs);
+	ILink *link = ilist_first(&l_bombs);
 	while(link) {
-		BombObject *bomb = (BombObject *)link->data;
+		BombObject *bomb = ilist_entry(link, BombObject, base.link);
 		game_draw(s_bomb, bomb->base.pos, &s_bomb_clips[bomb->sprite]);
-		link = list_next(link);
+		link = ilist_next(link);
 	}
 }
 
@@ -81,74 +99,88 @@ static void _bomb_evt_explosion_hit(void *event_data, void *user_data)
 	GameObject *obj = (GameObject *)event_data;
 
 	if (obj->type == OBJ_BOMB) {
-		BombObject *bomb = (BombObject *)obj;
-
-		// Set bomb timer to zero making it explode. The explosion cannot be done here because
-		// this event is raised if a bomb is currently exploding which means that we are
-		// in a loop through all bombs and can't delete bombs from the list.
-		bomb->time = 0;
+		// This event is raised while another bomb is exploding, so we might be in a
+		// walk through all bombs. This is fine, the bomb is removed from the list
+		// as soon as the walk has ended and the walk skips it from now on. This way
+		// a chain reaction is processed completely within one pass.
+		// The sound has already been played by the bomb which triggered this one.
+		_bomb_explode((BombObject *)obj, FALSE);
 	}
 }
 
 /**
- *  Timer callback function for the timer countdown.
- *  This timer determines how long a bomb lasts before exploding.
+ *  Event handler for the sim-step event.
+ *  Counts the bombs down every GAME_SLOW_STEPS steps, which determines how long
+ *  a bomb lasts before exploding.
  */
-static void _bomb_tmr_step(void *user_data)
+static void _bomb_evt_sim_step(void *event_data, void *user_data)
 {
-	List *link = list_first(l_bombs);
-
-	// Count each bomb down
-	while (link) {
-		BombObject *bomb = (BombObject *)link->data;
-		link = list_next(link);
+	IListIter iter;
+	ILink *link;
+	bool playsound = TRUE;
 
-		bomb->time--;
+	if (*(Uint64 *)event_data % GAME_SLOW_STEPS)
+		return;
 
+	// Count each bomb down. Bombs which explode during this walk, because they
+	// are hit by an explosion, are skipped.
+	for (link = ilist_begin(&l_bombs, &iter); link; link = ilist_iter_next(&iter, link)) {
+		BombObject *bomb = ilist_entry(link, BombObject, base.link);
 
-		// Calculate which explosion sprite to draw
-		float phase = (float)(bomb->time - 1) / BOMB_TIME * 8.0f;
-		int index_by_phase[] = { 0, 1, 2, 1 };
-		bomb->sprite = index_by_phase[(int)phase % 4];
-	}
-
-	// Let bombs explode which are zero
-	bool playsound = TRUE;
-	link = list_first(l_bombs);
-	while (link) {
-		BombObject *bomb = (BombObject *)link->data;
-		link = list_next(link);
+		bomb->time--;
 
 		if (bomb->time <= 0) {
-			Vector pos;
-
-			// If time is off: raise event, delete bomb, create explosion
-			event_raise("bomb-explode", bomb);
-			pos = bomb->base.pos;
-			bomb_free((GameObject *)bomb);
-			explosion_create(pos, bomb->exp_info, playsound);
+			// If time is off: let the bomb explode
+			_bomb_explode(bomb, playsound);
 
 			// Make sure that the sound is just played once
 			playsound = FALSE;
+			continue;
+		}
 
-			// Start again, because this bomb could have triggered other bombs
-			link = list_first(l_bombs);
+		// Calculate which explosion sprite to draw
+		float phase = (float)(bomb->time - 1) / BOMB_TIME * 8.0f;
+		int index_by_phase[] = { 0, 1, 2, 1 };
+		int sprite = index_by_phase[(int)phase % 4];
+		if (sprite != bomb->sprite) {
+			bomb->sprite = sprite;
+			game_invalidate_field(bomb->base.pos);
 		}
 	}
+	ilist_end(&iter);
 }
 
 
+/**
+ *  Release function of the bomb list. Frees a bomb object after
+ *  it has been unlinked from the list.
+ *
+ *  @param link		link of the bomb object
+ */
+static void _bomb_release(ILink *link)
+{
+	pool_free(ilist_entry(link, BombObject, base.link), sizeof(BombObject));
+}
+
 /**
  *  Initializes this module.
  */
 void bomb_init()
 {
+	// Our event handlers and timers are only needed in the game scene
+	int grp_game = group_register("game");
+
+	// Create the list of objects
+	ilist_init(&l_bombs, _bomb_release);
+
 	// Register events
+	ev_bomb_explode = event_register("bomb-explode");
 	evt_gfx_draw = event_connect("gfx-draw", 0, _bomb_evt_gfx_draw, NULL, EVENT_HANDLER_ENABLED);
 	evt_explosion_hit = event_connect("explosion-hit", 0, _bomb_evt_explosion_hit, NULL, EVENT_HANDLER_ENABLED);
-
-	// Initialize a timer bomb countdown
-	tmr_step = timer_create_interval(100, _bomb_tmr_step, NULL, TIMER_ENABLED);
+	evt_sim_step = event_connect("sim-step", 2, _bomb_evt_sim_step, NULL, EVENT_HANDLER_ENABLED);		// after the explosions, before the boxes
+	event_handler_set_group(evt_gfx_draw, grp_game);
+	event_handler_set_group(evt_explosion_hit, grp_game);
+	event_handler_set_group(evt_sim_step, grp_game);
 
 	// Load sprites
 	s_bomb = assert_sprite("sprites/bomb.png");
@@ -173,9 +205,7 @@ void bomb_destroy()
 	// Unregister events
 	event_disconnect(evt_gfx_draw);
 	event_disconnect(evt_explosion_hit);
-
-	// Free timers
-	timer_free(tmr_step);
+	event_disconnect(evt_sim_step);
 
 	// Free sprites
 	SDL_FreeSurface(s_bomb);
@@ -195,7 +225,7 @@ void bomb_destroy()
  */
 GameObject * bomb_create(Vector pos, GameObject *owner, ExplosionInfo *exp_info)
 {
-	BombObject *bomb = (BombObject *)malloc(sizeof(BombObject));
+	BombObject *bomb = (BombObject *)pool_alloc(sizeof(BombObject));
 	bomb->base.type = OBJ_BOMB;
 	bomb->owner = owner;
 	bomb->exp_info = exp_info;
@@ -203,9 +233,9 @@ GameObject * bomb_create(Vector pos, GameObject *owner, ExplosionInfo *exp_info)
 	bomb->sprite = 0;
 
 	game_set_field(pos, (GameObject *)bomb);
-	l_bombs = list_append(l_bombs, bomb);
+	ilist_append(&l_bombs, &bomb->base.link);
 
-	Mix_PlayChannel(-1, a_drop, 0);
+	sample_play(a_drop);
 
 	return (GameObject *)bomb;
 }
@@ -219,9 +249,7 @@ GameObject * bomb_create(Vector pos, GameObject *owner, ExplosionInfo *exp_info)
 void bomb_free(GameObject *bomb)
 {
 	game_set_field(bomb->pos, NULL);
-	l_bombs = list_remove(l_bombs, bomb);
-
-	free(bomb);
+	ilist_remove(&l_bombs, &bomb->link);
 }
 
 /**
@@ -230,13 +258,16 @@ void bomb_free(GameObject *bomb)
 void bomb_free_all()
 {
 	// Loop through all box objects
-	List *link = list_first(l_bombs);
+	IListIter iter;
+	ILink *link = ilist_begin(&l_bombs, &iter);
 	while (link) {
-		BombObject *bomb = (BombObject *)link->data;
-		link = list_next(link);
+		BombObject *bomb = ilist_entry(link, BombObject, base.link);
 
 		bomb_free((GameObject *)bomb);
+
+		link = ilist_iter_next(&iter, link);
 	}
+	ilist_end(&iter);
 }
 
 /**
@@ -40,6 +40,9 @@
 typedef struct {
 	GameObject base;				/**< data from the base class */
 	VectorF pos_exact;				/**< exact position of the bomberman */
+	VectorF pos_prev;				/**< exact position of the bomberman before the last simulation step */
+	VectorF pos_drawn;				/**< position at which the bomberman is drawn in the current frame */
+	int clip_drawn;					/**< clip which is drawn in the current frame, -1 if the bomberman hasn't been drawn yet */
 	Direction dir;					/**< direction in which the bomberman wants to walk */
 	BombermanColor color;			/**< color of the bomberman, used for selecting sprite sheet */
 	bool alive;						/**< wether the bomberman is still alive */
@@ -56,7 +59,7 @@ typedef struct {
 #define SPRITE_WALK_UP			10	/**< sprite for walking up */
 #define SPRITE_DEAD				19	/**< sprite for a dead bomberman */
 
-static List 		*l_bombermans = NULL;		/**< list of all existing bomberman objects */
+static IList 		 l_bombermans;					/**< list of all existing bomberman objects */
 
 static SDL_Surface	*s_bomberman[4];			/**< sprites for bomberman */
 static SDL_Rect		 s_bomberman_clips[20];		/**< clips which may be applied to all sprites */
@@ -65,7 +68,9 @@ static Mix_Chunk	*a_step;					/**< audio sample for a step */
 
 static int 			 evt_gfx_draw;				/**< id of the gfx-draw event handler */
 static int			 evt_bomb_explode;			/**< id of the bomb-explode event handler */
-static int 			 tmr_step;					/**< id of the timer step */
+static int			 ev_bomberman_died;			/**< id of the bomberman-died event */
+static int			 evt_sim_step;				/**< id of the sim-step event handler */
+static int			 evt_render;				/**< id of the render event handler */
 
 /**
  *  Checks wether a bomberman can walk over a specified field.
@@ -94,15 +99,45 @@ static bool _bomberman_check_pos(Vector pos)
 static void _bomberman_evt_gfx_draw(void *event_data, void *user_data)
 {
 	// Loop through all bomberman objects
-	List *link = list_first(l_bombermans);
+	ILink *link = ilist_first(&l_bombermans);
 	while (link) {
-		BombermanObject *bobj = (BombermanObject *)link->data;
+		BombermanObject *bobj = ilist_entry(link, BombermanObject, base.link);
+
+		if (bobj->clip_drawn >= 0)
+			game_draw_floating(s_bomberman[bobj->color], bobj->pos_drawn, &s_bomberman_clips[bobj->clip_drawn]);
+
+		link = ilist_next(link);
+	}
+}
+
+/**
+ *  Event handler for the render event.
+ *  Selects the clip and the position between the last two simulated positions at which
+ *  each bomberman is drawn in this frame. If they have changed, the old and the new
+ *  region are invalidated before the gfx module redraws the screen.
+ */
+static void _bomberman_evt_render(void *event_data, void *user_data)
+{
+	float alpha = *(float *)event_data;
+
+	// Loop through all bomberman objects
+	ILink *link = ilist_first(&l_bombermans);
+	while (link) {
+		BombermanObject *bobj = ilist_entry(link, BombermanObject, base.link);
 
-		// Select clip and draw the sprite
 		int clip_index = bobj->sprite + bobj->sprite_index;
-		game_draw_floating(s_bomberman[bobj->color], bobj->pos_exact, &s_bomberman_clips[clip_index]);
+		VectorF pos = vlerp(bobj->pos_prev, bobj->pos_exact, alpha);
+
+		if (clip_index != bobj->clip_drawn || pos.x != bobj->pos_drawn.x || pos.y != bobj->pos_drawn.y) {
+			if (bobj->clip_drawn >= 0)
+				game_invalidate_floating(s_bomberman[bobj->color], bobj->pos_drawn, &s_bomberman_clips[bobj->clip_drawn]);
+			game_invalidate_floating(s_bomberman[bobj->color], pos, &s_bomberman_clips[clip_index]);
 
-		link = list_next(link);
+			bobj->pos_drawn = pos;
+			bobj->clip_drawn = clip_index;
+		}
+
+		link = ilist_next(link);
 	}
 }
 
@@ -123,11 +158,11 @@ static void _bomberman_evt_bomb_explode(void *event_data, void *user_data)
 }
 
 /**
- *  Timer callback function for timer step.
+ *  Event handler for the sim-step event.
  *  Calculate all movement and checks wether a bomberman
  *  walks over an explosion or upgrade.
  */
-static void _bomberman_tmr_step(void *user_data)
+static void _bomberman_evt_sim_step(void *event_data, void *user_data)
 {
 	static int sprite_delay = 0;
 
@@ -135,10 +170,13 @@ static void _bomberman_tmr_step(void *user_data)
 	sprite_delay++;
 
 	// Loop through all bomberman objects
-	List *link = list_first(l_bombermans);
-	while (link) {
-		BombermanObject *bobj = (BombermanObject *)link->data;
-		link = list_next(link);
+	IListIter iter;
+	ILink *link;
+	for (link = ilist_begin(&l_bombermans, &iter); link; link = ilist_iter_next(&iter, link)) {
+		BombermanObject *bobj = ilist_entry(link, BombermanObject, base.link);
+
+		// Keep the position of the previous step for drawing
+		bobj->pos_prev = bobj->pos_exact;
 
 		// If the bomberman isn't alive anymore, just draw the right sprite
 		if (!bobj->alive){
@@ -216,7 +254,7 @@ static void _bomberman_tmr_step(void *user_data)
 		}
 		// Otherwise create a sound effect
 		else if (sprite_delay % 12 == 0) {
-			Mix_PlayChannel(-1, a_step, 0);
+			sample_play(a_step);
 		}
 
 		// Check wether the bomberman walks over an explosion or upgrade
@@ -229,7 +267,7 @@ static void _bomberman_tmr_step(void *user_data)
 				bobj->sprite_index = -3;
 
 				// Raise event
-				event_raise("bomberman-died", bobj);
+				event_raise_id(ev_bomberman_died, bobj);
 			}
 
 			if (object->type == OBJ_UPGRADE) {
@@ -239,6 +277,18 @@ static void _bomberman_tmr_step(void *user_data)
 			}
 		}
 	}
+	ilist_end(&iter);
+}
+
+/**
+ *  Release function of the bomberman list. Frees a bomberman object after
+ *  it has been unlinked from the list.
+ *
+ *  @param link		link of the bomberman object
+ */
+static void _bomberman_release(ILink *link)
+{
+	pool_free(ilist_entry(link, BombermanObject, base.link), sizeof(BombermanObject));
 }
 
 /**
@@ -246,12 +296,22 @@ static void _bomberman_tmr_step(void *user_data)
  */
 void bomberman_init()
 {
+	// Our event handlers and timers are only needed in the game scene
+	int grp_game = group_register("game");
+
+	// Create the list of objects
+	ilist_init(&l_bombermans, _bomberman_release);
+
 	// Register events
+	ev_bomberman_died = event_register("bomberman-died");
 	evt_gfx_draw = event_connect("gfx-draw", 0, _bomberman_evt_gfx_draw, NULL, EVENT_HANDLER_ENABLED);
 	evt_bomb_explode = event_connect("bomb-explode", 0, _bomberman_evt_bomb_explode, NULL, EVENT_HANDLER_ENABLED);
-
-	// Initialize timers
-	tmr_step = timer_create_interval(20, _bomberman_tmr_step, NULL, TIMER_ENABLED);
+	evt_sim_step = event_connect("sim-step", 0, _bomberman_evt_sim_step, NULL, EVENT_HANDLER_ENABLED);
+	evt_render = event_connect("render", 1, _bomberman_evt_render, NULL, EVENT_HANDLER_ENABLED);		// before the gfx module draws
+	event_handler_set_group(evt_gfx_draw, grp_game);
+	event_handler_set_group(evt_bomb_explode, grp_game);
+	event_handler_set_group(evt_sim_step, grp_game);
+	event_handler_set_group(evt_render, grp_game);
 
 	// Load sprites
 	s_bomberman[0] = assert_sprite("sprites/bomberman1.png");
@@ -277,7 +337,8 @@ void bomberman_destroy()
 
 	// Unregister events
 	event_disconnect(evt_gfx_draw);
-	timer_free(tmr_step);
+	event_disconnect(evt_sim_step);
+	event_disconnect(evt_render);
 
 	// Free sprites
 	SDL_FreeSurface(s_bomberman[0]);
@@ -298,11 +359,14 @@ void bomberman_destroy()
  */
 GameObject * bomberman_create(Vector pos, BombermanColor color)
 {
-	BombermanObject *bobj = (BombermanObject *)malloc(sizeof(BombermanObject));
+	BombermanObject *bobj = (BombermanObject *)pool_alloc(sizeof(BombermanObject));
 	bobj->base.type = OBJ_BOMBERMAN;
 	bobj->base.pos = pos;
 
 	bobj->pos_exact = vrect(pos.x, pos.y);
+	bobj->pos_prev = bobj->pos_exact;
+	bobj->pos_drawn = bobj->pos_exact;
+	bobj->clip_drawn = -1;
 	bobj->dir = DIR_NONE;
 	bobj->alive = TRUE;
 	bobj->color = color;
@@ -315,7 +379,7 @@ GameObject * bomberman_create(Vector pos, BombermanColor color)
 	bobj->sprite_index = 0;
 	bobj->sprite_inc = 1;
 
-	l_bombermans = list_append(l_bombermans, bobj);
+	ilist_append(&l_bombermans, &bobj->base.link);
 
 	return (GameObject *)bobj;
 }
@@ -325,8 +389,12 @@ GameObject * bomberman_create(Vector pos, BombermanColor color)
  */
 void bomberman_free(GameObject *bomberman)
 {
-	l_bombermans = list_remove(l_bombermans, bomberman);
-	free(bomberman);
+	BombermanObject *bobj = (BombermanObject *)bomberman;
+
+	if (bobj->clip_drawn >= 0)
+		game_invalidate_floating(s_bomberman[bobj->color], bobj->pos_drawn, &s_bomberman_clips[bobj->clip_drawn]);
+
+	ilist_remove(&l_bombermans, &bomberman->link);
 }
 
 /**
@@ -335,14 +403,17 @@ void bomberman_free(GameObject *bomberman)
 void bomberman_free_all()
 {
 	// Loop through all bomberman objects
-	List *link = list_first(l_bombermans);
+	IListIter iter;
+	ILink *link = ilist_begin(&l_bombermans, &iter);
 	while (link) {
-		BombermanObject *bobj = (BombermanObject *)link->data;
-		link = list_next(link);
+		BombermanObject *bobj = ilist_entry(link, BombermanObject, base.link);
 
 		// Free everyone
 		bomberman_free((GameObject *)bobj);
+
+		link = ilist_iter_next(&iter, link);
 	}
+	ilist_end(&iter);
 }
 
 /**
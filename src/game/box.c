@@ -38,28 +38,62 @@ typedef struct {
 	int sprite;									/**< current sprite index used by the box */
 } BoxObject;
 
-static List			*l_boxes = NULL;			/**< list of all existing box objects */
+/**
+ *  The data of the box-opened event.
+ */
+typedef struct {
+	Vector pos;									/**< position of the box which has vanished */
+	GameObject *content;						/**< the game object which was in the box */
+} BoxOpenedData;
+
+static IList			 l_boxes;						/**< list of all existing box objects */
 
 static SDL_Surface	*s_box;						/**< box sprites */
 static SDL_Rect		 s_box_clips[7];			/**< clips for box sprites */
 
 static int			 evt_gfx_draw;				/**< id of the gfx-draw event handler */
+static int			 evt_game_layer_draw;		/**< id of the game-layer-draw event handler */
 static int			 evt_explosion_hit;			/**< id of the explosion-hit event handler */
 
-static int			 tmr_step;					/**< id of the timer which is used to create explosion animation */
+static int			 evt_sim_step;				/**< id of the sim-step event handler, which is used to create explosion animation */
+static int			 evt_box_opened;			/**< id of the box-opened event handler */
+
+static int			 ev_box_opened;				/**< id of the box-opened event */
 
 /**
  *  Event handler for the gfx-draw event.
- *  Draws all boxes.
+ *  Draws the boxes which are being destroyed. Intact boxes are part of the box layer.
  */
 static void _box_evt_gfx_draw(void *event_data, void *user_data)
 {
 	// Loop through all box objects
-	List *link = list_first(l_boxes);
+	ILink *link = ilist_first(&l_boxes);
+	while (link) {
+		BoxObject *box = ilist_entry(link, BoxObject, base.link);
+		if (box->sprite > 0) {
+			game_draw(s_box, box->base.pos, &s_box_clips[box->sprite]);
+		}
+		link = ilist_next(link);
+	}
+}
+
+/**
+ *  Event handler for the game-layer-draw event.
+ *  Draws all intact boxes into the box layer.
+ */
+static void _box_evt_game_layer_draw(void *event_data, void *user_data)
+{
+	if (*(GameLayer *)event_data != GAME_LAYER_BOXES)
+		return;
+
+	// Loop through all box objects
+	ILink *link = ilist_first(&l_boxes);
 	while (link) {
-		BoxObject *box = (BoxObject *)link->data;
-		game_draw(s_box, box->base.pos, &s_box_clips[box->sprite]);
-		link = list_next(link);
+		BoxObject *box = ilist_entry(link, BoxObject, base.link);
+		if (box->sprite == 0) {
+			game_draw(s_box, box->base.pos, &s_box_clips[0]);
+		}
+		link = ilist_next(link);
 	}
 }
 
@@ -75,43 +109,72 @@ static void _box_evt_explosion_hit(void *event_data, void *user_data)
 		BoxObject *box = (BoxObject *)obj;
 
 		// Initialize the animation. The box is freed if animation has finished.
+		// The animation is drawn on every frame, so the box is taken out of the box layer.
 		if (box->sprite == 0) {
 			box->sprite = 1;
+			game_layer_remove(box->base.pos);
 		}
 	}
 }
 
 /**
- *  Timer callback function for the timer step.
- *  Used for animation while being destroyed by an explosion.
+ *  Event handler for the sim-step event.
+ *  Used for animation while being destroyed by an explosion, every GAME_SLOW_STEPS steps.
  */
-static void _box_tmr_step(void *user_data)
+static void _box_evt_sim_step(void *event_data, void *user_data)
 {
+	if (*(Uint64 *)event_data % GAME_SLOW_STEPS)
+		return;
+
 	// Loop through all box objects
-	List *link = list_first(l_boxes);
+	IListIter iter;
+	ILink *link = ilist_begin(&l_boxes, &iter);
 	while (link) {
-		BoxObject *box = (BoxObject *)link->data;
-		link = list_next(link);
+		BoxObject *box = ilist_entry(link, BoxObject, base.link);
 
 		// Update the sprite being used
 		if (box->sprite > 0) {
 			box->sprite++;
-			if (box->sprite > 7) {
-				// Get content
-				GameObject *content = box->content;
-				Vector pos = box->base.pos;
+			game_invalidate_field(box->base.pos);
+			if (box->sprite > 6) {
+				// The content is unpacked after the step, so it appears at once
+				// for all objects, no matter in which order they are moved.
+				if (box->content) {
+					BoxOpenedData data = { box->base.pos, box->content };
+					event_post_id(ev_box_opened, &data, sizeof(data));
+				}
 
 				// Free the box
 				box->content = NULL;
 				box_free((GameObject *)box);
-
-				// Unpack content
-				if (content) {
-					game_set_field(pos, content);
-				}
 			}
 		}
+
+		link = ilist_iter_next(&iter, link);
 	}
+	ilist_end(&iter);
+}
+
+/**
+ *  Event handler for the box-opened event, which is posted when a box has vanished.
+ *  Places the content of the box on its field.
+ */
+static void _box_evt_box_opened(void *event_data, void *user_data)
+{
+	BoxOpenedData *data = (BoxOpenedData *)event_data;
+
+	game_set_field(data->pos, data->content);
+}
+
+/**
+ *  Release function of the box list. Frees a box object after
+ *  it has been unlinked from the list.
+ *
+ *  @param link		link of the box object
+ */
+static void _box_release(ILink *link)
+{
+	pool_free(ilist_entry(link, BoxObject, base.link), sizeof(BoxObject));
 }
 
 /**
@@ -119,12 +182,24 @@ static void _box_tmr_step(void *user_data)
  */
 void box_init()
 {
+	// Our event handlers and timers are only needed in the game scene
+	int grp_game = group_register("game");
+
+	// Create the list of objects
+	ilist_init(&l_boxes, _box_release);
+
 	// Register events
 	evt_gfx_draw = event_connect("gfx-draw", 0, _box_evt_gfx_draw, NULL, EVENT_HANDLER_ENABLED);
+	evt_game_layer_draw = event_connect("game-layer-draw", 0, _box_evt_game_layer_draw, NULL, EVENT_HANDLER_ENABLED);
 	evt_explosion_hit = event_connect("explosion-hit", 0, _box_evt_explosion_hit, NULL, EVENT_HANDLER_ENABLED);
-
-	// Create timers
-	tmr_step = timer_create_interval(100, _box_tmr_step, NULL, TIMER_ENABLED);
+	evt_sim_step = event_connect("sim-step", 1, _box_evt_sim_step, NULL, EVENT_HANDLER_ENABLED);
+	ev_box_opened = event_register("box-opened");
+	evt_box_opened = event_connect("box-opened", 0, _box_evt_box_opened, NULL, EVENT_HANDLER_ENABLED);
+	event_handler_set_group(evt_gfx_draw, grp_game);
+	event_handler_set_group(evt_game_layer_draw, grp_game);
+	event_handler_set_group(evt_explosion_hit, grp_game);
+	event_handler_set_group(evt_sim_step, grp_game);
+	event_handler_set_group(evt_box_opened, grp_game);
 
 	// Load sprites
 	s_box = assert_sprite("sprites/box.png");
@@ -144,10 +219,10 @@ void box_destroy()
 
 	// Unregister events
 	event_disconnect(evt_gfx_draw);
+	event_disconnect(evt_game_layer_draw);
 	event_disconnect(evt_explosion_hit);
-
-	// Free timers
-	timer_free(tmr_step);
+	event_disconnect(evt_sim_step);
+	event_disconnect(evt_box_opened);
 
 	// Free sprites
 	SDL_FreeSurface(s_box);
@@ -161,13 +236,13 @@ void box_destroy()
  */
 GameObject * box_create(Vector pos)
 {
-	BoxObject *box = (BoxObject *)malloc(sizeof(BoxObject));
+	BoxObject *box = (BoxObject *)pool_alloc(sizeof(BoxObject));
 	box->base.type = OBJ_BOX;
 	box->content = NULL;
 	box->sprite = 0;
 
 	game_set_field(pos, (GameObject *)box);
-	l_boxes = list_append(l_boxes, box);
+	ilist_append(&l_boxes, &box->base.link);
 
 	return (GameObject *)box;
 }
@@ -182,14 +257,18 @@ void box_free(GameObject *box)
 {
 	BoxObject *obj = (BoxObject *)box;
 
-	game_set_field(obj->base.pos, NULL);
-	l_boxes = list_remove(l_boxes, obj);
-
 	if (obj->content) {
 		game_free_object(obj->content);
 	}
 
-	free(obj);
+	// An intact box is still part of the box layer
+	if (obj->sprite == 0) {
+		game_layer_remove(obj->base.pos);
+	}
+
+	// This frees the object unless the list is walked right now
+	game_set_field(obj->base.pos, NULL);
+	ilist_remove(&l_boxes, &obj->base.link);
 }
 
 /**
@@ -198,13 +277,16 @@ void box_free(GameObject *box)
 void box_free_all()
 {
 	// Loop through all box objects
-	List *link = list_first(l_boxes);
+	IListIter iter;
+	ILink *link = ilist_begin(&l_boxes, &iter);
 	while (link) {
-		BoxObject *box = (BoxObject *)link->data;
-		link = list_next(link);
+		BoxObject *box = ilist_entry(link, BoxObject, base.link);
 
 		box_free((GameObject *)box);
+
+		link = ilist_iter_next(&iter, link);
 	}
+	ilist_end(&iter);
 }
 
 /**
@@ -218,37 +300,36 @@ void box_free_all()
 int box_distribute(GameObject *content[], int n_content)
 {
 	BoxObject *box;
-
-	// Create a list of all empty boxes
-	List *empty_boxes = NULL;
+	BoxObject **empty_boxes;
 	int empty_box_count = 0;
 
-	List *link = list_first(l_boxes);
+	// Create an array of all empty boxes
+	empty_boxes = (BoxObject **)malloc(ilist_length(&l_boxes) * sizeof(BoxObject *));
+
+	ILink *link = ilist_first(&l_boxes);
 	while (link) {
-		box = (BoxObject *)link->data;
+		box = ilist_entry(link, BoxObject, base.link);
 
 		if (!box->content) {
-			// Use prepend because it's faster
-			empty_boxes = list_prepend(empty_boxes, box);
-			empty_box_count++;
+			empty_boxes[empty_box_count++] = box;
 		}
 
-		link = list_next(link);
+		link = ilist_next(link);
 	}
 
-	int i;
+	int i, n;
 	for (i = 0; i < n_content; i++) {
 		// Break, if there are no more empty boxes
 		if (empty_box_count <= 0) break;
 
-		box = (BoxObject *)list_nth(empty_boxes, rand2(0, empty_box_count - 1))->data;
+		// Pick a random box and replace it by the last one in the array
+		n = rand2(0, empty_box_count - 1);
+		box = empty_boxes[n];
 		box->content = content[i];
-		empty_boxes = list_remove(empty_boxes, box);
-
-		empty_box_count--;
+		empty_boxes[n] = empty_boxes[--empty_box_count];
 	}
 
-	empty_boxes = list_free(empty_boxes);
+	free(empty_boxes);
 
 	return i;
 }
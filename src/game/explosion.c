@@ -54,10 +54,11 @@ typedef struct {
 	int sprite_index;							/**< sprite index (intensity) currently used */
 } ExplosionObject;
 
-static List 		*l_explosions = NULL;		/**< list of all existing explosion objects */
+static IList 		 l_explosions;					/**< list of all existing explosion objects */
 
 static int		 	 evt_gfx_draw;				/**< id of the gfx-draw event handler */
-static int			 tmr_step;					/**< id of the step timer */
+static int			 ev_explosion_hit;			/**< id of the explosion-hit event */
+static int			 evt_sim_step;				/**< id of the sim-step event handler */
 
 static SDL_Surface	*s_explosion[5];			/**< sprites for the explosion */
 static SDL_Rect		 s_explosion_clips[7];		/**< clips for the sprites */
@@ -90,20 +91,20 @@ static int _explosion_create_field(Vector pos, int sprite, ExplosionObject **obj
 			explosion_free(field);
 		}
 		else {
-			event_raise("explosion-hit", field);
+			event_raise_id(ev_explosion_hit, field);
 			return 0;
 		}
 	}
 
 	// Create explosion object
-	ExplosionObject *explosion = (ExplosionObject *)malloc(sizeof(ExplosionObject));
+	ExplosionObject *explosion = (ExplosionObject *)pool_alloc(sizeof(ExplosionObject));
 	explosion->base.type = OBJ_EXPLOSION;
 	explosion->time = EXPLOSION_TIME;
 	explosion->sprite = sprite;
 	explosion->sprite_index = 2;
 
 	game_set_field(pos, (GameObject *)explosion);
-	l_explosions = list_append(l_explosions, explosion);
+	ilist_append(&l_explosions, &explosion->base.link);
 
 	// Return the object, if a pointer location was specified
 	if (obj) *obj = explosion;
@@ -117,43 +118,69 @@ static int _explosion_create_field(Vector pos, int sprite, ExplosionObject **obj
  */
 static void _explosion_evt_gfx_draw(void *event_data, void *user_data)
 {
-	List *link = list_first(l_explosions);
+	ILink *link = ilist_first(&l_explosions);
 
 	// Draw all existing explosion fields
 	while (link) {
-		ExplosionObject *explosion = (ExplosionObject *)link->data;
+		ExplosionObject *explosion = ilist_entry(link, ExplosionObject, base.link);
 
 		// The explosion is represented by sprites :D
 		game_draw(s_explosion[explosion->sprite_index], explosion->base.pos, &s_explosion_clips[explosion->sprite]);
 
-		link = list_next(link);
+		link = ilist_next(link);
 	}
 }
 
 /**
- *  Timer callback function for the timer countdown.
- *  This timer determines how long an explosion lasts.
+ *  Event handler for the sim-step event.
+ *  Counts the explosions down every GAME_SLOW_STEPS steps, which determines
+ *  how long an explosion lasts.
  */
-static void _explosion_tmr_step(void *user_data)
+static void _explosion_evt_sim_step(void *event_data, void *user_data)
 {
-	List *link = list_first(l_explosions);
+	IListIter iter;
+	ILink *link;
+
+	if (*(Uint64 *)event_data % GAME_SLOW_STEPS)
+		return;
+
+	link = ilist_begin(&l_explosions, &iter);
 
 	// Count each explosion down
 	while(link) {
-		ExplosionObject *explosion = (ExplosionObject *)link->data;
-		link = list_next(link);
+		ExplosionObject *explosion = ilist_entry(link, ExplosionObject, base.link);
 
 		explosion->time--;
 
+		if(explosion->time <= 0) {
+			explosion_free((GameObject *)explosion);
+			link = ilist_iter_next(&iter, link);
+			continue;
+		}
+
 		// Calculate which explosion sprite to draw
 		float phase = (float)(explosion->time - 1) / EXPLOSION_TIME * 6.0f;
 		int index_by_phase[] = { 0, 1, 2, 3, 4, 3, 2 };
-		explosion->sprite_index = index_by_phase[(int)phase];
-
-		if(explosion->time <= 0) {
-			explosion_free((GameObject *)explosion);
+		int sprite_index = index_by_phase[(int)phase];
+		if (sprite_index != explosion->sprite_index) {
+			explosion->sprite_index = sprite_index;
+			game_invalidate_field(explosion->base.pos);
 		}
+
+		link = ilist_iter_next(&iter, link);
 	}
+	ilist_end(&iter);
+}
+
+/**
+ *  Release function of the explosion list. Frees a explosion object after
+ *  it has been unlinked from the list.
+ *
+ *  @param link		link of the explosion object
+ */
+static void _explosion_release(ILink *link)
+{
+	pool_free(ilist_entry(link, ExplosionObject, base.link), sizeof(ExplosionObject));
 }
 
 /**
@@ -161,11 +188,18 @@ static void _explosion_tmr_step(void *user_data)
  */
 void explosion_init()
 {
+	// Our event handlers and timers are only needed in the game scene
+	int grp_game = group_register("game");
+
+	// Create the list of objects
+	ilist_init(&l_explosions, _explosion_release);
+
 	// Register events
+	ev_explosion_hit = event_register("explosion-hit");
 	evt_gfx_draw = event_connect("gfx-draw", 0, _explosion_evt_gfx_draw, NULL, EVENT_HANDLER_ENABLED);
-
-	// Initialize a timer for explosion countdown
-	tmr_step = timer_create_interval(100, _explosion_tmr_step, NULL, TIMER_ENABLED);
+	evt_sim_step = event_connect("sim-step", 3, _explosion_evt_sim_step, NULL, EVENT_HANDLER_ENABLED);	// before the bombs, so new explosions aren't aged right away
+	event_handler_set_group(evt_gfx_draw, grp_game);
+	event_handler_set_group(evt_sim_step, grp_game);
 
 	// Load sprites
 	s_explosion[0] = assert_sprite("sprites/explosion5.png");
@@ -192,9 +226,7 @@ void explosion_destroy()
 
 	// Unregister events
 	event_disconnect(evt_gfx_draw);
-
-	// Destroy timer
-	timer_free(tmr_step);
+	event_disconnect(evt_sim_step);
 
 	// Free sprites
 	SDL_FreeSurface(s_explosion[0]);
@@ -302,7 +334,7 @@ GameObject * explosion_create(Vector pos, ExplosionInfo *info, bool playsound)
 
 	// Play sound
 	if (playsound) {
-		Mix_PlayChannel(-1, a_explosion, 0);
+		sample_play(a_explosion);
 	}
 
 	return (GameObject *)explosion;
@@ -317,9 +349,7 @@ GameObject * explosion_create(Vector pos, ExplosionInfo *info, bool playsound)
 void explosion_free(GameObject *explosion)
 {
 	game_set_field(explosion->pos, NULL);
-	l_explosions = list_remove(l_explosions, explosion);
-
-	free(explosion);
+	ilist_remove(&l_explosions, &explosion->link);
 }
 
 /**
@@ -328,13 +358,16 @@ void explosion_free(GameObject *explosion)
 void explosion_free_all()
 {
 	// Loop through all box explosion objects
-	List *link = list_first(l_explosions);
+	IListIter iter;
+	ILink *link = ilist_begin(&l_explosions, &iter);
 	while (link) {
-		ExplosionObject *explosion = (ExplosionObject *)link->data;
-		link = list_next(link);
+		ExplosionObject *explosion = ilist_entry(link, ExplosionObject, base.link);
 
 		explosion_free((GameObject *)explosion);
+
+		link = ilist_iter_next(&iter, link);
 	}
+	ilist_end(&iter);
 }
 
 /** @} */
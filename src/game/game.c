@@ -24,6 +24,8 @@
  *  @{
  */
 
+#include <stdlib.h>			// atof function
+#include <stdio.h>			// printf function
 #include <string.h>			// memset function
 #include <SDL/SDL.h>
 #include <SDL/SDL_ttf.h>
@@ -43,6 +45,8 @@
 #define PADDING					50									/**< padding around the playfield in pixels */
 #define NUM_UPG_BOMB			10									/**< number of bomb upgrades in total */
 #define NUM_UPG_EXPL			10									/**< number of explosion upgrades in total */
+#define AUTOPLAY_MIN_STEPS		5									/**< minimal number of simulation steps a bot keeps its decision */
+#define AUTOPLAY_MAX_STEPS		25									/**< maximal number of simulation steps a bot keeps its decision */
 
 static Size   		 field_size;									/**< size of one field. this is calculated during initialization */
 static Vector 		 screen_offset;									/**< offset which we use to start drawing */
@@ -50,6 +54,12 @@ static Vector 		 screen_offset;									/**< offset which we use to start drawin
 static int			 countdown_index;								/**< counter which is used for the countdown at the beginning of a game */
 static bool			 gameover;										/**< wether the game is over */
 
+static bool			 autoplay;										/**< whether the bombermans are controlled by bots instead of the keyboard */
+static int			 autoplay_wait[2];								/**< number of simulation steps until each bot decides again */
+static int			 n_matches;										/**< number of matches played so far */
+static int			 max_matches;									/**< number of matches after which the application quits, 0 for no limit */
+static Uint64		 match_start;									/**< simulation step at which the current match has started */
+
 static GameObject	*a_world[GAME_WORLD_WIDTH][GAME_WORLD_HEIGHT];	/**< the 2D array containing all game objects except the bombermans */
 static List			*l_bombermans = NULL;							/**< the list containing all bomberman objects */
 
@@ -58,6 +68,9 @@ static SDL_Surface  *s_countdown[3];								/**< surfaces containing messages fo
 static SDL_Surface  *s_gameover;									/**< surface containing game over message */
 
 static SDL_Surface	*s_screen;										/**< screen surface of the gfx module */
+static SDL_Surface	*s_target;										/**< layer which is being built, NULL if game_draw() submits to the render queue */
+static SDL_Surface	*s_layer_background;							/**< cached layer with the border, the grass and the rocks */
+static SDL_Surface	*s_layer_boxes;									/**< cached layer with the intact boxes on top of the background */
 static SDL_Surface	*s_grass;										/**< grass sprite */
 static SDL_Surface  *s_rock;										/**< rock sprite */
 
@@ -74,8 +87,14 @@ static int 			 evt_sdl_key_down;								/**< id of the sdl-key-down event handle
 static int 			 evt_sdl_key_up;								/**< id of the sdl-key-up event handler */
 static int 			 evt_scene_changed;								/**< id of the scene-changed event handler */
 static int			 evt_bomberman_died;							/**< id of the bomberman-died event handler */
+static int			 evt_sim_step;									/**< id of the sim-step event handler */
+static int			 ev_game_layer_draw;							/**< id of the game-layer-draw event */
+
+static int			 grp_game;										/**< id of the group of all event handlers and timers of the game */
+static int			 scn_game;										/**< id of the game scene */
 
 static int			 tmr_game_init;									/**< id of the game-init timer */
+static int			 tmr_game_over;									/**< id of the game-over timer */
 
 // --- Default Playfield ------------------------------------------------------------------------------------------------------------------
 
@@ -99,13 +118,83 @@ static const ObjectType default_world[GAME_WORLD_HEIGHT][GAME_WORLD_WIDTH] = {
 		{ OBJ_NONE, OBJ_NONE, OBJ_BOX,  OBJ_BOX,  OBJ_BOX,  OBJ_BOX,  OBJ_BOX,  OBJ_BOX,  OBJ_BOX,  OBJ_BOX,  OBJ_BOX,  OBJ_BOX,  OBJ_BOX,  OBJ_NONE, OBJ_NONE },
 };
 
-// --- Event Handlers ---------------------------------------------------------------------------------------------------------------------
+// --- Static Functions -------------------------------------------------------------------------------------------------------------------
 
 /**
- *  Event handler for the gfx-draw event.
- *  This function draws the background of the game.
+ *  Lets a bot control a bomberman. The bot walks into a random direction for a random
+ *  number of simulation steps and lays a bomb now and then.
+ *
+ *  @param bomberman	a bomberman object
+ *  @param wait			[in,out] number of simulation steps until the bot decides again
  */
-static void _game_evt_gfx_draw(void *event_data, void *user_data)
+static void _game_autoplay(GameObject *bomberman, int *wait)
+{
+	static const Direction dirs[] = { DIR_NONE, DIR_UP, DIR_DOWN, DIR_LEFT, DIR_RIGHT };
+
+	if (!bomberman_is_alive(bomberman) || --(*wait) > 0)
+		return;
+
+	bomberman_set_direction(bomberman, dirs[rand2(0, 5)]);
+	if (rand2(0, 4) == 0)
+		bomberman_lay_bomb(bomberman);
+
+	*wait = rand2(AUTOPLAY_MIN_STEPS, AUTOPLAY_MAX_STEPS);
+}
+
+/**
+ *  Calculates the region of the screen covered by a sprite drawn onto the playfield.
+ *  Sprites which are higher than one field are aligned at the bottom of the field.
+ *
+ *  @param sprite	sprite which is drawn
+ *  @param pos		coordinates of the field where the sprite is drawn
+ *  @param clip		part of the surface which is drawn (optional)
+ *  @param dest		[out] the region in screen coordinates
+ */
+static void _game_get_sprite_rect(SDL_Surface *sprite, VectorF pos, SDL_Rect *clip, SDL_Rect *dest)
+{
+	Vector posi;
+	int w, h;
+
+	// Get coordinates
+	posi = vrecti(fround(pos.x), fround(pos.y));
+	game_get_field_coords(posi, dest);
+
+	// Apply floating part
+	dest->x += (pos.x - (float)posi.x) * dest->w;
+	dest->y += (pos.y - (float)posi.y) * dest->h;
+
+	// Adjust y coordinate for sprites which are higher than one field height
+	w = clip ? clip->w : sprite->w;
+	h = clip ? clip->h : sprite->h;
+	dest->y = dest->y + dest->h - h;
+	dest->w = w;
+	dest->h = h;
+}
+
+/**
+ *  Draws a sprite onto the layer which is being built or submits it to the render queue.
+ *
+ *  @param sprite	sprite which shall be drawn
+ *  @param pos		coordinates of the field where to draw the surface
+ *  @param clip		part of the surface which to draw (optional)
+ *  @param layer	layer of the render queue
+ */
+static void _game_draw_sprite(SDL_Surface *sprite, VectorF pos, SDL_Rect *clip, GfxLayer layer)
+{
+	SDL_Rect dest;
+
+	_game_get_sprite_rect(sprite, pos, clip, &dest);
+
+	if (s_target)
+		gfx_blit(sprite, clip, s_target, dest.x, dest.y);
+	else
+		gfx_submit(sprite, clip, dest.x, dest.y, layer);
+}
+
+/**
+ *  Draws the border around the playfield and the grass.
+ */
+static void _game_draw_background()
 {
 	int x, y;
 
@@ -128,28 +217,88 @@ static void _game_evt_gfx_draw(void *event_data, void *user_data)
 	}
 }
 
+/**
+ *  Renders a text message in the pixel format of the screen, so it can be drawn by the
+ *  rasterizer of the gfx module.
+ *
+ *  @param text		the text
+ *  @param color	color of the text
+ *
+ *  @returns		the surface containing the text
+ */
+static SDL_Surface * _game_render_text(char *text, SDL_Color color)
+{
+	SDL_Surface *tmp, *surface;
+
+	tmp = TTF_RenderText_Solid(f_default, text, color);
+	assert_ptr(tmp, "couldn't render text", TTF_GetError);
+
+	surface = SDL_DisplayFormat(tmp);
+	SDL_FreeSurface(tmp);
+	assert_ptr(surface, "couldn't convert text", SDL_GetError);
+
+	// The color key is kept, but without RLE acceleration
+	SDL_SetColorKey(surface, SDL_SRCCOLORKEY, surface->format->colorkey);
+
+	return surface;
+}
+
+/**
+ *  Builds the cached layers of the playfield at the beginning of a match. Objects which
+ *  belong to a layer draw themselves during the game-layer-draw event.
+ */
+static void _game_build_layers()
+{
+	GameLayer layer;
+
+	// Nothing is drawn if the application runs headless
+	if (!s_screen)
+		return;
+
+	// Background: border, grass and rocks
+	layer = GAME_LAYER_BACKGROUND;
+	s_target = s_layer_background;
+	SDL_FillRect(s_layer_background, NULL, SDL_MapRGB(s_layer_background->format, 0, 0, 0));
+	_game_draw_background();
+	event_raise_id(ev_game_layer_draw, &layer);
+
+	// Boxes on top of a copy of the background
+	layer = GAME_LAYER_BOXES;
+	s_target = s_layer_boxes;
+	gfx_blit(s_layer_background, NULL, s_layer_boxes, 0, 0);
+	event_raise_id(ev_game_layer_draw, &layer);
+
+	s_target = NULL;
+	gfx_invalidate(NULL);
+}
+
+// --- Event Handlers ---------------------------------------------------------------------------------------------------------------------
+
+/**
+ *  Event handler for the gfx-draw event.
+ *  This function draws the cached layers of the playfield with one sprite.
+ */
+static void _game_evt_gfx_draw(void *event_data, void *user_data)
+{
+	gfx_submit(s_layer_boxes, NULL, 0, 0, GFX_LAYER_BACKGROUND);
+}
+
 /**
  *  Event handler for the gfx-draw event.
  *  This function draws text messages.
  */
 static void _game_evt_gfx_draw_text(void *event_data, void *user_data)
 {
-	SDL_Rect dest;
-
 	// Draw countdown
 	if (countdown_index >= 0) {
 		SDL_Surface *s_msg = s_countdown[countdown_index];
 
-		dest.x = GFX_SCREEN_WIDTH / 2 - s_msg->w / 2;
-		dest.y = GFX_SCREEN_HEIGHT / 2 - s_msg->h / 2;
-		SDL_BlitSurface(s_msg, NULL, s_screen, &dest);
+		gfx_submit(s_msg, NULL, GFX_SCREEN_WIDTH / 2 - s_msg->w / 2, GFX_SCREEN_HEIGHT / 2 - s_msg->h / 2, GFX_LAYER_OVERLAY);
 	}
 
 	// Draw game over message
 	if (gameover) {
-		dest.x = GFX_SCREEN_WIDTH / 2 - s_gameover->w / 2;
-		dest.y = GFX_SCREEN_HEIGHT / 2 - s_gameover->h / 2;
-		SDL_BlitSurface(s_gameover, NULL, s_screen, &dest);
+		gfx_submit(s_gameover, NULL, GFX_SCREEN_WIDTH / 2 - s_gameover->w / 2, GFX_SCREEN_HEIGHT / 2 - s_gameover->h / 2, GFX_LAYER_OVERLAY);
 	}
 }
 
@@ -283,18 +432,29 @@ static void _game_evt_sdl_key_up(void *event_data, void *user_data)
 	bomberman_set_direction(bm_keyboard2, dir2);
 }
 
+/**
+ *  Event handler for the sim-step event.
+ *  Lets the bots control the bombermans if the game is played automatically.
+ */
+static void _game_evt_sim_step(void *event_data, void *user_data)
+{
+	// The bots have to wait for the countdown like the players
+	if (countdown_index > 0 || gameover)
+		return;
+
+	_game_autoplay(bm_keyboard1, &autoplay_wait[0]);
+	_game_autoplay(bm_keyboard2, &autoplay_wait[1]);
+}
+
 /**
  *  Event handler for the scene-changed event.
  *  This starts respectively stops the game.
  */
 static void _game_evt_scene_changed(void *event_data, void *user_data)
 {
-	if (scene_check("game")) {
-		// Enable events
-		event_handler_set_state(evt_gfx_draw, EVENT_HANDLER_ENABLED);
-		event_handler_set_state(evt_gfx_draw_text, EVENT_HANDLER_ENABLED);
-		event_handler_set_state(evt_bomberman_died, EVENT_HANDLER_ENABLED);
-
+	// The event handlers and timers of the game group have already been
+	// enabled respectively disabled by the scene module.
+	if (scene_check_id(scn_game)) {
 		// Create bombermans
 		bm_keyboard1 = bomberman_create(vrecti(GAME_WORLD_WIDTH - 1, GAME_WORLD_HEIGHT - 1), BM_WHITE);
 		bm_keyboard2 = bomberman_create(vrecti(0, 0), BM_BLUE);
@@ -338,23 +498,30 @@ static void _game_evt_scene_changed(void *event_data, void *user_data)
 
 		box_distribute(upgrades, i);
 
+		// Draw the parts of the playfield which don't change during the match
+		_game_build_layers();
+
 		// Initialize countdown
 		gameover = FALSE;
 		countdown_index = 2;
 		timer_set_state(tmr_game_init, TIMER_ENABLED);
-		event_handler_set_state(evt_gfx_draw_text, EVENT_HANDLER_ENABLED);
-		Mix_PlayChannel(-1, a_countdown1, 0);
+		sample_play(a_countdown1);
+
+		autoplay_wait[0] = autoplay_wait[1] = 0;
+		match_start = loop_get_step();
+
+		// Let the simulation run
+		clock_set_paused(CLOCK_GAME, FALSE);
 	}
 	else {
-		// Disable events
-		event_handler_set_state(evt_gfx_draw, EVENT_HANDLER_DISABLED);
-		event_handler_set_state(evt_gfx_draw_text, EVENT_HANDLER_DISABLED);
+		// Stop the simulation, so no time is spent on the game timers
+		clock_set_paused(CLOCK_GAME, TRUE);
+
+		// Reset the countdown, so that the players can't move at the beginning of the next game
 		event_handler_set_state(evt_sdl_key_down, EVENT_HANDLER_DISABLED);
 		event_handler_set_state(evt_sdl_key_up, EVENT_HANDLER_DISABLED);
-		event_handler_set_state(evt_bomberman_died, EVENT_HANDLER_DISABLED);
-
-		// Disable timers
 		timer_set_state(tmr_game_init, TIMER_DISABLED);
+		timer_set_state(tmr_game_over, TIMER_DISABLED);
 
 		// Free all objects
 		bomberman_free_all();
@@ -392,7 +559,8 @@ static void _game_evt_bomberman_died(void *event_data, void *user_data)
 
 	if (n_bombermans_alive < 2) {
 		gameover = TRUE;
-		Mix_PlayChannel(-1, a_gameover, 0);
+		gfx_invalidate(NULL);
+		sample_play(a_gameover);
 
 		// Make sure nobody dies
 		bomb_free_all();
@@ -404,6 +572,17 @@ static void _game_evt_bomberman_died(void *event_data, void *user_data)
 			bomberman_set_direction(bomberman, DIR_NONE);
 			link = list_next(link);
 		}
+
+		// Report the result of automatically played matches and start the next one soon
+		if (autoplay) {
+			n_matches++;
+			printf("match %d: %s after %llu steps\n", n_matches,
+					bomberman_is_alive(bm_keyboard1) ? "player 1 won" :
+					bomberman_is_alive(bm_keyboard2) ? "player 2 won" : "draw",
+					(unsigned long long)(loop_get_step() - match_start));
+
+			timer_set_state(tmr_game_over, TIMER_ENABLED);
+		}
 	}
 }
 
@@ -418,13 +597,16 @@ static void _game_tmr_game_init(void *user_data)
 {
 	countdown_index--;
 
+	// The message in the middle of the screen changes
+	gfx_invalidate(NULL);
+
 	if (countdown_index > 0) {
 		// Lower tone
-		Mix_PlayChannel(-1, a_countdown1, 0);
+		sample_play(a_countdown1);
 	}
 	else if (countdown_index == 0) {
 		// Higher tone
-		Mix_PlayChannel(-1, a_countdown2, 0);
+		sample_play(a_countdown2);
 
 		// Enable events. The players can move if the "Go"-Sprite appears.
 		event_handler_set_state(evt_sdl_key_up, EVENT_HANDLER_ENABLED);
@@ -436,6 +618,25 @@ static void _game_tmr_game_init(void *user_data)
 	}
 }
 
+/**
+ *  Callback function for the game-over timer.
+ *  This timer restarts an automatically played game after the game over message
+ *  has been shown, or quits the application if enough matches have been played.
+ */
+static void _game_tmr_game_over(void *user_data)
+{
+	timer_set_state(tmr_game_over, TIMER_DISABLED);
+
+	if (max_matches && n_matches >= max_matches) {
+		clock_set_paused(CLOCK_GAME, TRUE);
+		application_quit();
+		return;
+	}
+
+	scene_pop();
+	scene_push_id(scn_game);
+}
+
 // --- Public Functions -------------------------------------------------------------------------------------------------------------------
 
 /**
@@ -444,6 +645,7 @@ static void _game_tmr_game_init(void *user_data)
 void game_init()
 {
 	int field_size1, field_size2;
+	char *option;
 
 	// Initialize the playfield
 	memset(a_world, 0, sizeof(a_world));
@@ -463,19 +665,57 @@ void game_init()
 		screen_offset.y = PADDING;
 	}
 
+	// Create the group of the game, it is only active in the game scene
+	scn_game = scene_register("game");
+	grp_game = group_register("game");
+	group_bind_scene(grp_game, scn_game);
+
 	// Register events
-	evt_gfx_draw = event_connect("gfx-draw", 1, _game_evt_gfx_draw, NULL, EVENT_HANDLER_DISABLED);
-	evt_gfx_draw_text = event_connect("gfx-draw", -1, _game_evt_gfx_draw_text, NULL, EVENT_HANDLER_DISABLED);
+	ev_game_layer_draw = event_register("game-layer-draw");
+	evt_gfx_draw = event_connect("gfx-draw", 1, _game_evt_gfx_draw, NULL, EVENT_HANDLER_ENABLED);
+	evt_gfx_draw_text = event_connect("gfx-draw", -1, _game_evt_gfx_draw_text, NULL, EVENT_HANDLER_ENABLED);
 	evt_sdl_key_down = event_connect("sdl-key-down", 0, _game_evt_sdl_key_down, NULL, EVENT_HANDLER_DISABLED);
 	evt_sdl_key_up = event_connect("sdl-key-up", 0, _game_evt_sdl_key_up, NULL, EVENT_HANDLER_DISABLED);
 	evt_scene_changed = event_connect("scene-changed", 0, _game_evt_scene_changed, NULL, EVENT_HANDLER_ENABLED);
-	evt_bomberman_died = event_connect("bomberman-died", 0, _game_evt_bomberman_died, NULL, EVENT_HANDLER_DISABLED);
+	evt_bomberman_died = event_connect("bomberman-died", 0, _game_evt_bomberman_died, NULL, EVENT_HANDLER_ENABLED);
+	evt_sim_step = event_connect("sim-step", 4, _game_evt_sim_step, NULL, EVENT_HANDLER_DISABLED);		// before any object moves
+	event_handler_set_group(evt_gfx_draw, grp_game);
+	event_handler_set_group(evt_gfx_draw_text, grp_game);
+	event_handler_set_group(evt_sdl_key_down, grp_game);
+	event_handler_set_group(evt_sdl_key_up, grp_game);
+	event_handler_set_group(evt_bomberman_died, grp_game);
+	event_handler_set_group(evt_sim_step, grp_game);
+
+	// Bots play instead of the keyboard if the application runs headless or --autoplay is passed.
+	// Headless, only one match is played unless --matches=N is given (0 plays forever).
+	autoplay = application_is_headless() || application_get_option("autoplay");
+	if (autoplay)
+		event_handler_set_state(evt_sim_step, EVENT_HANDLER_ENABLED);
+
+	option = application_get_option("matches");
+	max_matches = option ? atoi(option) : (application_is_headless() ? 1 : 0);
+	n_matches = 0;
+
+	// The game clock only runs in the game scene, at the speed given by --time-scale.
+	// Headless, the simulation runs as fast as possible by default.
+	option = application_get_option("time-scale");
+	if ((option && strcmp(option, "unlimited") == 0) || (!option && application_is_headless()))
+		clock_set_scale(CLOCK_GAME, CLOCK_SCALE_UNLIMITED);
+	else if (option && atof(option) >= 0.0)
+		clock_set_scale(CLOCK_GAME, atof(option));
+	clock_set_paused(CLOCK_GAME, TRUE);
 
 	// Create timers
 	tmr_game_init = timer_create_interval(1000, _game_tmr_game_init, NULL, TIMER_DISABLED);
+	timer_set_group(tmr_game_init, grp_game);
+	timer_set_clock(tmr_game_init, CLOCK_GAME);
+	tmr_game_over = timer_create_interval(2000, _game_tmr_game_over, NULL, TIMER_DISABLED);
+	timer_set_group(tmr_game_over, grp_game);
+	timer_set_clock(tmr_game_over, CLOCK_GAME);
 
 	// Load sprites
 	s_screen = gfx_get_screen();
+	s_target = NULL;
 	s_grass = assert_sprite("sprites/grass.png");
 	s_rock = assert_sprite("sprites/rock.png");
 
@@ -484,10 +724,24 @@ void game_init()
 
 	// Render texts
 	SDL_Color color = { 255, 0, 0 };
-	s_countdown[2] = TTF_RenderText_Solid(f_default, "Ready", color);
-	s_countdown[1] = TTF_RenderText_Solid(f_default, "Set", color);
-	s_countdown[0] = TTF_RenderText_Solid(f_default, "Go!", color);
-	s_gameover =	 TTF_RenderText_Solid(f_default, "Game Over", color);
+	memset(s_countdown, 0, sizeof(s_countdown));
+	s_gameover = NULL;
+	if (f_default) {
+		s_countdown[2] = _game_render_text("Ready", color);
+		s_countdown[1] = _game_render_text("Set", color);
+		s_countdown[0] = _game_render_text("Go!", color);
+		s_gameover =	 _game_render_text("Game Over", color);
+	}
+
+	// Create the cached layers
+	s_layer_background = s_layer_boxes = NULL;
+	if (s_screen) {
+		SDL_PixelFormat *fmt = s_screen->format;
+		s_layer_background = SDL_CreateRGBSurface(SDL_SWSURFACE, GFX_SCREEN_WIDTH, GFX_SCREEN_HEIGHT, fmt->BitsPerPixel, fmt->Rmask, fmt->Gmask, fmt->Bmask, 0);
+		s_layer_boxes = SDL_CreateRGBSurface(SDL_SWSURFACE, GFX_SCREEN_WIDTH, GFX_SCREEN_HEIGHT, fmt->BitsPerPixel, fmt->Rmask, fmt->Gmask, fmt->Bmask, 0);
+		assert_ptr(s_layer_background, "couldn't create layer", SDL_GetError);
+		assert_ptr(s_layer_boxes, "couldn't create layer", SDL_GetError);
+	}
 
 	// Load audio files
 	a_countdown1 = assert_sample("sounds/countdown-a.ogg");
@@ -515,9 +769,11 @@ void game_destroy()
 	event_disconnect(evt_sdl_key_up);
 	event_disconnect(evt_scene_changed);
 	event_disconnect(evt_bomberman_died);
+	event_disconnect(evt_sim_step);
 
 	// Free timers
 	timer_free(tmr_game_init);
+	timer_free(tmr_game_over);
 
 	// Free sprites
 	SDL_FreeSurface(s_grass);
@@ -530,7 +786,8 @@ void game_destroy()
 	SDL_FreeSurface(s_gameover);
 
 	// Free fonts
-	TTF_CloseFont(f_default);
+	if (f_default)
+		TTF_CloseFont(f_default);
 
 	// Free audio files
 	Mix_FreeChunk(a_countdown1);
@@ -545,6 +802,10 @@ void game_destroy()
 	box_destroy();
 	upgrade_destroy();
 
+	// Free layers, after the boxes have been removed from them
+	SDL_FreeSurface(s_layer_background);
+	SDL_FreeSurface(s_layer_boxes);
+
 	// Free other stuff
 	l_bombermans = list_free(l_bombermans);
 }
@@ -583,6 +844,7 @@ void game_set_field(Vector pos, GameObject *obj)
 	if (pos.y < 0 || pos.y >= GAME_WORLD_HEIGHT) return;
 
 	a_world[pos.x][pos.y] = obj;
+	game_invalidate_field(pos);
 }
 
 /**
@@ -603,6 +865,7 @@ void game_get_field_coords(Vector pos, SDL_Rect *coords)
 
 /**
  *  Draws a sprite onto the playfield.
+ *  The sprite lies on the ground, so it is drawn below all objects drawn by game_draw_floating().
  *
  *  @param sprite	sprite which shall be drawn
  *  @param pos		coordinates of the field where to draw the surface
@@ -610,7 +873,7 @@ void game_get_field_coords(Vector pos, SDL_Rect *coords)
  */
 void game_draw(SDL_Surface *sprite, Vector pos, SDL_Rect *clip)
 {
-	game_draw_floating(sprite, vrect((int)pos.x, (int)pos.y), clip);
+	_game_draw_sprite(sprite, vrect((int)pos.x, (int)pos.y), clip, GFX_LAYER_GROUND);
 }
 
 /**
@@ -624,27 +887,55 @@ void game_draw(SDL_Surface *sprite, Vector pos, SDL_Rect *clip)
  */
 void game_draw_floating(SDL_Surface *sprite, VectorF pos, SDL_Rect *clip)
 {
-	Vector posi;
-	SDL_Rect dest;
+	_game_draw_sprite(sprite, pos, clip, GFX_LAYER_OBJECTS);
+}
 
-	// Get coordinates
-	posi = vrecti(fround(pos.x), fround(pos.y));
-	game_get_field_coords(posi, &dest);
+/**
+ *  Removes an object from the cached box layer by restoring the background of its field.
+ *  This must be done as soon as an intact box is hit or freed.
+ *
+ *  @param pos		coordinates of the field
+ */
+void game_layer_remove(Vector pos)
+{
+	SDL_Rect rect;
 
-	// Apply floating part
-	dest.x += (pos.x - (float)posi.x) * dest.w;
-	dest.y += (pos.y - (float)posi.y) * dest.h;
+	if (!s_screen)
+		return;
 
-	// Adjust y coordinate for sprites which are higher than one field height
-	if (clip) {
-		dest.y = dest.y + dest.h - clip->h;
-	}
-	else {
-		dest.y = dest.y + dest.h - sprite->h;
-	}
+	game_get_field_coords(pos, &rect);
+	gfx_blit(s_layer_background, &rect, s_layer_boxes, rect.x, rect.y);
+
+	game_invalidate_field(pos);
+}
+
+/**
+ *  Invalidates a field of the playfield, so it is redrawn in the next frame (see gfx_invalidate()).
+ *
+ *  @param pos		coordinates of the field
+ */
+void game_invalidate_field(Vector pos)
+{
+	SDL_Rect rect;
+
+	game_get_field_coords(pos, &rect);
+	gfx_invalidate(&rect);
+}
+
+/**
+ *  Invalidates the region of the screen covered by a sprite drawn by game_draw_floating(),
+ *  so it is redrawn in the next frame (see gfx_invalidate()).
+ *
+ *  @param sprite	sprite which is drawn
+ *  @param pos		coordinates of the field where the sprite is drawn
+ *  @param clip		part of the surface which is drawn (optional)
+ */
+void game_invalidate_floating(SDL_Surface *sprite, VectorF pos, SDL_Rect *clip)
+{
+	SDL_Rect rect;
 
-	// Blit surface
-	SDL_BlitSurface(sprite, clip, s_screen, &dest);
+	_game_get_sprite_rect(sprite, pos, clip, &rect);
+	gfx_invalidate(&rect);
 }
 
 /**
@@ -659,8 +950,8 @@ void game_free_object(GameObject *obj)
 		l_bombermans = list_remove(l_bombermans, obj);
 	}
 	else {
-		// Remove from world array
-		a_world[obj->pos.x][obj->pos.y] = NULL;
+		// Remove from world array. The content of a box isn't placed in the world yet.
+		game_set_field(obj->pos, NULL);
 	}
 
 	// Call the right free function
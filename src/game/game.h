@@ -28,6 +28,10 @@
  *  the a game round is correctly started and finished. Further it
  *  processes any inputs from the keyboard to control the bombermans.
  *
+ *  If the application runs headless or the option --autoplay is passed, the bombermans
+ *  are controlled by simple bots instead. Then every finished match is reported on the
+ *  standard output and the next one is started, until --matches=N matches have been played.
+ *
  *  @{
  */
 
@@ -36,9 +40,11 @@
 
 #include <SDL/SDL.h>
 #include "core/common.h"
+#include "core/ilist.h"
 
 #define GAME_WORLD_WIDTH		15		/**< width of the world in fields */
 #define GAME_WORLD_HEIGHT		11		/**< height of the world in fields */
+#define GAME_SLOW_STEPS			5		/**< bombs, boxes and explosions are updated every 5th simulation step (100 ms) */
 
 /**
  *  This enum type defines an identifier for each game object type.
@@ -63,6 +69,16 @@ typedef enum {
 	COL_YELLOW		= 4,	/**< color id for a yellow bomberman */
 } Color;
 
+/**
+ *  The cached layers of the playfield, which are built once per match. While a layer is
+ *  built, the game-layer-draw event is raised with a pointer to its id, then the objects
+ *  which belong to it draw themselves by game_draw().
+ */
+typedef enum {
+	GAME_LAYER_BACKGROUND	= 0,	/**< the border, the grass and the rocks, which never change during a match */
+	GAME_LAYER_BOXES		= 1,	/**< the intact boxes on top of the background (see game_layer_remove()) */
+} GameLayer;
+
 /**
  *  This struct holds the data for a game object.
  *  It is the base of all game objects.
@@ -70,6 +86,7 @@ typedef enum {
 typedef struct {
 	ObjectType 		type;		/**< type id of the game object */
 	Vector 			pos;		/**< position of the game object */
+	ILink			link;		/**< link in the list of all objects of the same type */
 } GameObject;
 
 extern void game_init();
@@ -80,6 +97,9 @@ extern void game_set_field(Vector pos, GameObject *obj);
 extern void game_get_field_coords(Vector pos, SDL_Rect *coords);
 extern void game_draw(SDL_Surface *sprite, Vector pos, SDL_Rect *clip);
 extern void game_draw_floating(SDL_Surface *sprite, VectorF pos, SDL_Rect *clip);
+extern void game_invalidate_field(Vector pos);
+extern void game_invalidate_floating(SDL_Surface *sprite, VectorF pos, SDL_Rect *clip);
+extern void game_layer_remove(Vector pos);
 
 extern void game_free_object(GameObject *obj);
 
@@ -38,32 +38,53 @@ typedef struct {
 	GameObject base;						/**< data from the base class */
 } RockObject;
 
-static List			*l_rocks = NULL;		/**< list of all existing rock objects */
+static IList			 l_rocks;					/**< list of all existing rock objects */
 static SDL_Surface	*s_rock;				/**< rock sprite */
-static int			 evt_gfx_draw;			/**< id of the gfx-draw event handler */
+static int			 evt_game_layer_draw;	/**< id of the game-layer-draw event handler */
 
 /**
- *  Event handler for the gfx-draw event.
- *  Draws all rocks.
+ *  Event handler for the game-layer-draw event.
+ *  Draws all rocks into the background layer, since they never change.
  */
-static void _rock_evt_gfx_draw(void *event_data, void *user_data)
+static void _rock_evt_game_layer_draw(void *event_data, void *user_data)
 {
+	if (*(GameLayer *)event_data != GAME_LAYER_BACKGROUND)
+		return;
+
 	// Loop through all rock objects
-	List *link = list_first(l_rocks);
+	ILink *link = ilist_first(&l_rocks);
 	while (link) {
-		RockObject *rock = (RockObject *)link->data;
+		RockObject *rock = ilist_entry(link, RockObject, base.link);
 		game_draw(s_rock, rock->base.pos, NULL);
-		link = list_next(link);
+		link = ilist_next(link);
 	}
 }
 
+/**
+ *  Release function of the rock list. Frees a rock object after
+ *  it has been unlinked from the list.
+ *
+ *  @param link		link of the rock object
+ */
+static void _rock_release(ILink *link)
+{
+	pool_free(ilist_entry(link, RockObject, base.link), sizeof(RockObject));
+}
+
 /**
  *  Initializes this module.
  */
 void rock_init()
 {
+	// Our event handlers and timers are only needed in the game scene
+	int grp_game = group_register("game");
+
+	// Create the list of objects
+	ilist_init(&l_rocks, _rock_release);
+
 	// Register events
-	evt_gfx_draw = event_connect("gfx-draw", 0, _rock_evt_gfx_draw, NULL, EVENT_HANDLER_ENABLED);
+	evt_game_layer_draw = event_connect("game-layer-draw", 0, _rock_evt_game_layer_draw, NULL, EVENT_HANDLER_ENABLED);
+	event_handler_set_group(evt_game_layer_draw, grp_game);
 
 	// Load sprites
 	s_rock = assert_sprite("sprites/rock.png");
@@ -78,7 +99,7 @@ void rock_destroy()
 	rock_free_all();
 
 	// Unregister events
-	event_disconnect(evt_gfx_draw);
+	event_disconnect(evt_game_layer_draw);
 
 	// Free sprites
 	SDL_FreeSurface(s_rock);
@@ -92,11 +113,11 @@ void rock_destroy()
  */
 GameObject * rock_create(Vector pos)
 {
-	RockObject *rock = (RockObject *)malloc(sizeof(RockObject));
+	RockObject *rock = (RockObject *)pool_alloc(sizeof(RockObject));
 	rock->base.type = OBJ_ROCK;
 
 	game_set_field(pos, (GameObject *)rock);
-	l_rocks = list_append(l_rocks, rock);
+	ilist_append(&l_rocks, &rock->base.link);
 
 	return (GameObject *)rock;
 }
@@ -109,9 +130,7 @@ GameObject * rock_create(Vector pos)
 void rock_free(GameObject *rock)
 {
 	game_set_field(rock->pos, NULL);
-	l_rocks = list_remove(l_rocks, rock);
-
-	free(rock);
+	ilist_remove(&l_rocks, &rock->link);
 }
 
 /**
@@ -120,13 +139,16 @@ void rock_free(GameObject *rock)
 void rock_free_all()
 {
 	// Loop through all rock objects
-	List *link = list_first(l_rocks);
+	IListIter iter;
+	ILink *link = ilist_begin(&l_rocks, &iter);
 	while (link) {
-		RockObject *rock = (RockObject *)link->data;
-		link = list_next(link);
+		RockObject *rock = ilist_entry(link, RockObject, base.link);
 
 		rock_free((GameObject *)rock);
+
+		link = ilist_iter_next(&iter, link);
 	}
+	ilist_end(&iter);
 }
 
 /** @} */
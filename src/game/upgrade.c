@@ -39,7 +39,7 @@ typedef struct {
 	UpgradeType type;						/**< type of the upgrade (equal to the sprite index) */
 } UpgradeObject;
 
-static List			*l_upgrades = NULL;		/**< list of all existing upgrade objects */
+static IList			 l_upgrades;					/**< list of all existing upgrade objects */
 
 static SDL_Surface	*s_upgrade;				/**< upgrade sprite */
 static SDL_Rect		 s_upgrade_clips[7];	/**< clips for the upgrade sprite */
@@ -57,15 +57,15 @@ static int			 evt_explosion_hit;		/**< id of the explosion-hit event handler */
 static void _upgrade_evt_gfx_draw(void *event_data, void *user_data)
 {
 	// Loop through all upgrade objects
-	List *link = list_first(l_upgrades);
+	ILink *link = ilist_first(&l_upgrades);
 	while (link) {
-		UpgradeObject *upgrade = (UpgradeObject *)link->data;
+		UpgradeObject *upgrade = ilist_entry(link, UpgradeObject, base.link);
 
 		if (upgrade->base.pos.x >= 0 && upgrade->base.pos.y >= 0) {
 			game_draw(s_upgrade, upgrade->base.pos, &s_upgrade_clips[upgrade->type]);
 		}
 
-		link = list_next(link);
+		link = ilist_next(link);
 	}
 }
 
@@ -83,14 +83,33 @@ static void _upgrade_evt_explosion_hit(void *event_data, void *user_data)
 	}
 }
 
+/**
+ *  Release function of the upgrade list. Frees a upgrade object after
+ *  it has been unlinked from the list.
+ *
+ *  @param link		link of the upgrade object
+ */
+static void _upgrade_release(ILink *link)
+{
+	pool_free(ilist_entry(link, UpgradeObject, base.link), sizeof(UpgradeObject));
+}
+
 /**
  *  Initializes this module.
  */
 void upgrade_init()
 {
+	// Our event handlers and timers are only needed in the game scene
+	int grp_game = group_register("game");
+
+	// Create the list of objects
+	ilist_init(&l_upgrades, _upgrade_release);
+
 	// Register events
 	evt_gfx_draw = event_connect("gfx-draw", 0, _upgrade_evt_gfx_draw, NULL, EVENT_HANDLER_ENABLED);
 	evt_explosion_hit = event_connect("explosion-hit", 0, _upgrade_evt_explosion_hit, NULL, EVENT_HANDLER_ENABLED);
+	event_handler_set_group(evt_gfx_draw, grp_game);
+	event_handler_set_group(evt_explosion_hit, grp_game);
 
 	// Load sprites
 	s_upgrade = assert_sprite("sprites/upgrades.png");
@@ -131,14 +150,14 @@ void upgrade_destroy()
  */
 GameObject * upgrade_create(Vector pos, UpgradeType type)
 {
-	UpgradeObject *upgrade = (UpgradeObject *)malloc(sizeof(UpgradeObject));
+	UpgradeObject *upgrade = (UpgradeObject *)pool_alloc(sizeof(UpgradeObject));
 	upgrade->base.type = OBJ_UPGRADE;
 	upgrade->base.pos = pos;
 	upgrade->type = type;
 
 	game_set_field(pos, (GameObject *)upgrade);
 
-	l_upgrades = list_append(l_upgrades, upgrade);
+	ilist_append(&l_upgrades, &upgrade->base.link);
 
 	return (GameObject *)upgrade;
 }
@@ -152,9 +171,7 @@ void upgrade_free(GameObject *upgrade)
 {
 	game_set_field(upgrade->pos, NULL);
 
-	l_upgrades = list_remove(l_upgrades, upgrade);
-
-	free(upgrade);
+	ilist_remove(&l_upgrades, &upgrade->link);
 }
 
 /**
@@ -163,13 +180,16 @@ void upgrade_free(GameObject *upgrade)
 void upgrade_free_all()
 {
 	// Loop through all upgrade objects
-	List *link = list_first(l_upgrades);
+	IListIter iter;
+	ILink *link = ilist_begin(&l_upgrades, &iter);
 	while (link) {
-		UpgradeObject *upgrade = (UpgradeObject *)link->data;
-		link = list_next(link);
+		UpgradeObject *upgrade = ilist_entry(link, UpgradeObject, base.link);
 
 		upgrade_free((GameObject *)upgrade);
+
+		link = ilist_iter_next(&iter, link);
 	}
+	ilist_end(&iter);
 }
 
 /**
@@ -197,7 +217,7 @@ void upgrade_apply(GameObject *upgrade, UpgradeInfo *target)
 	}
 
 	// Play sound
-	Mix_PlayChannel(-1, a_pick, 0);
+	sample_play(a_pick);
 }
 
 /** @} */
@@ -24,34 +24,452 @@
  *  @{
  */
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 #include <SDL/SDL.h>
 #include "core/core.h"
+#include "blit.h"
 #include "gfx.h"
 
 
 
+/**
+ *  A sprite in the render queue.
+ */
+typedef struct {
+	SDL_Surface		*sheet;			/**< the sprite sheet */
+	SDL_Rect		 clip;			/**< the part of the sprite sheet which is drawn */
+	SDL_Rect		 dest;			/**< the region of the screen which is covered */
+	int				 layer;			/**< the layer (see GfxLayer) */
+	int				 order;			/**< the position in which the sprite has been submitted */
+} GfxCommand;
+
+/**
+ *  A thread which rasterizes one band of every redrawn region.
+ */
+typedef struct {
+	SDL_Thread		*thread;		/**< the thread or NULL for the main thread */
+	SDL_sem			*start;			/**< posted by the main thread when a frame has to be rasterized */
+	int				 band;			/**< index of the band which is rasterized by this thread */
+	Uint64			 blits;			/**< number of sprites drawn by this thread in total */
+} GfxWorker;
+
 static SDL_Surface 		*screen;						/**< surface which is displayed */
 
-static int 				 tmr_draw;						/**< id of the timer which raises the gfx-draw event */
+static bool				 dirty_rects;					/**< whether only the invalidated regions are redrawn, FALSE with --full-redraw */
+static SDL_Rect			 a_dirty[GFX_MAX_DIRTY_RECTS];	/**< the regions of the screen which have been invalidated since the last frame */
+static int				 n_dirty = 0;					/**< number of invalidated regions */
+static bool				 full_redraw = TRUE;			/**< whether the whole screen has to be redrawn */
+
+static GfxCommand		 a_commands[GFX_MAX_COMMANDS];	/**< the render queue of the current frame */
+static int				 n_commands = 0;				/**< number of sprites in the render queue */
+static bool				 rasterizable = TRUE;			/**< whether all sprites of the render queue can be drawn by the rasterizer */
+
+static GfxWorker		 a_workers[GFX_MAX_THREADS];	/**< the rasterizing threads, the first one is the main thread */
+static int				 n_threads = 1;					/**< number of rasterizing threads, including the main thread */
+static int				 n_bands = 1;					/**< number of bands into which the regions of the current frame are split */
+static SDL_Rect			*a_regions;						/**< the regions which are redrawn in the current frame */
+static int				 n_regions = 0;					/**< number of regions which are redrawn in the current frame */
+static SDL_sem			*sem_done;						/**< posted by a worker thread when it has finished its bands */
+static bool				 workers_quit = FALSE;			/**< tells the worker threads to quit */
+
+static Uint64			 n_frames = 0;					/**< number of presented frames */
+static Uint64			 n_full_frames = 0;				/**< number of frames for which the whole screen has been redrawn */
+static Uint64			 n_rects = 0;					/**< number of redrawn regions in total */
+static Uint64			 n_pixels = 0;					/**< number of redrawn pixels in total */
+static Uint64			 n_submitted = 0;				/**< number of sprites submitted to the render queue in total */
+static Uint64			 n_dropped = 0;					/**< number of sprites dropped because the render queue was full */
+static Uint64			 n_threaded_frames = 0;			/**< number of frames which have been rasterized by more than one thread */
+static Uint64			 n_sdl_frames = 0;				/**< number of frames which have been drawn by SDL */
+
+static int 				 evt_render;					/**< id of the render event handler */
+static int				 evt_scene_changed;				/**< id of the scene-changed event handler */
+
+static int				 ev_gfx_draw;					/**< id of the gfx-draw event */
+
+/**
+ *  Checks whether two rectangles overlap or touch each other.
+ *
+ *  @param a		a rectangle
+ *  @param b		another rectangle
+ *
+ *  @returns		TRUE if the rectangles overlap or touch, otherwise FALSE
+ */
+static bool _gfx_rects_touch(SDL_Rect *a, SDL_Rect *b)
+{
+	return a->x <= b->x + b->w && b->x <= a->x + a->w &&
+		   a->y <= b->y + b->h && b->y <= a->y + a->h;
+}
+
+/**
+ *  Extends a rectangle so that it contains another one.
+ *
+ *  @param a		[in,out] the rectangle to extend
+ *  @param b		the rectangle to include
+ */
+static void _gfx_rects_union(SDL_Rect *a, SDL_Rect *b)
+{
+	int x1 = (a->x < b->x) ? a->x : b->x;
+	int y1 = (a->y < b->y) ? a->y : b->y;
+	int x2 = (a->x + a->w > b->x + b->w) ? a->x + a->w : b->x + b->w;
+	int y2 = (a->y + a->h > b->y + b->h) ? a->y + a->h : b->y + b->h;
+
+	a->x = x1;
+	a->y = y1;
+	a->w = x2 - x1;
+	a->h = y2 - y1;
+}
+
+/**
+ *  Compares two sprites of the render queue by layer, bottom edge, sprite sheet and
+ *  the order of submission, so sorting is deterministic.
+ */
+static int _gfx_command_compare(const void *a, const void *b)
+{
+	const GfxCommand *ca = (const GfxCommand *)a;
+	const GfxCommand *cb = (const GfxCommand *)b;
+	int bottom_a = ca->dest.y + ca->dest.h;
+	int bottom_b = cb->dest.y + cb->dest.h;
+
+	if (ca->layer != cb->layer)
+		return ca->layer - cb->layer;
+	if (bottom_a != bottom_b)
+		return bottom_a - bottom_b;
+	if (ca->sheet != cb->sheet)
+		return (ca->sheet < cb->sheet) ? -1 : 1;
+	return ca->order - cb->order;
+}
+
+/**
+ *  Fills a rectangle of the screen with the background color.
+ *
+ *  @param rect		the rectangle, which must lie within the screen
+ */
+static void _gfx_raster_fill(SDL_Rect *rect)
+{
+	Uint32 *dst = (Uint32 *)((Uint8 *)screen->pixels + rect->y * screen->pitch) + rect->x;
+
+	blit_fill(dst, screen->pitch, rect->w, rect->h, SDL_MapRGB(screen->format, 0, 0, 0));
+}
+
+/**
+ *  Checks whether the rasterizer can draw a sprite sheet onto a surface. Both must have the
+ *  same 32-bit pixel format and the sprite sheet may only use a color key and a per-surface
+ *  alpha value.
+ *
+ *  @param sheet	the sprite sheet
+ *  @param target	the surface
+ *
+ *  @returns		TRUE if the rasterizer can draw the sprite sheet, otherwise FALSE
+ */
+static bool _gfx_can_raster(SDL_Surface *sheet, SDL_Surface *target)
+{
+	SDL_PixelFormat *src = sheet->format;
+	SDL_PixelFormat *dst = target->format;
+
+	if (src->BytesPerPixel != 4 || dst->BytesPerPixel != 4 || (sheet->flags & SDL_RLEACCEL))
+		return FALSE;
+	if (src->Rmask != dst->Rmask || src->Gmask != dst->Gmask || src->Bmask != dst->Bmask)
+		return FALSE;
+
+	return !(sheet->flags & SDL_SRCALPHA) || src->Amask == 0;
+}
+
+/**
+ *  Initializes a sprite of the render queue. The part of the sprite sheet is clipped to
+ *  its size, like SDL does.
+ *
+ *  @param cmd		[out] the sprite
+ *  @param sheet	the sprite sheet
+ *  @param clip		the part of the sprite sheet to draw or NULL for the whole sheet
+ *  @param x		x coordinate of the upper left corner on the screen
+ *  @param y		y coordinate of the upper left corner on the screen
+ *
+ *  @returns		FALSE if nothing is left to draw, otherwise TRUE
+ */
+static bool _gfx_command_init(GfxCommand *cmd, SDL_Surface *sheet, SDL_Rect *clip, int x, int y)
+{
+	if (clip) {
+		cmd->clip = *clip;
+	}
+	else {
+		cmd->clip.x = cmd->clip.y = 0;
+		cmd->clip.w = sheet->w;
+		cmd->clip.h = sheet->h;
+	}
+
+	if (cmd->clip.x < 0) {
+		x -= cmd->clip.x;
+		cmd->clip.w = (cmd->clip.w > -cmd->clip.x) ? cmd->clip.w + cmd->clip.x : 0;
+		cmd->clip.x = 0;
+	}
+	if (cmd->clip.y < 0) {
+		y -= cmd->clip.y;
+		cmd->clip.h = (cmd->clip.h > -cmd->clip.y) ? cmd->clip.h + cmd->clip.y : 0;
+		cmd->clip.y = 0;
+	}
+	if (cmd->clip.x + cmd->clip.w > sheet->w)
+		cmd->clip.w = (cmd->clip.x < sheet->w) ? sheet->w - cmd->clip.x : 0;
+	if (cmd->clip.y + cmd->clip.h > sheet->h)
+		cmd->clip.h = (cmd->clip.y < sheet->h) ? sheet->h - cmd->clip.y : 0;
+	if (!cmd->clip.w || !cmd->clip.h)
+		return FALSE;
+
+	cmd->sheet = sheet;
+	cmd->dest.x = x;
+	cmd->dest.y = y;
+	cmd->dest.w = cmd->clip.w;
+	cmd->dest.h = cmd->clip.h;
+	return TRUE;
+}
 
 /**
- *  Callback function for tmr_draw.
- *  This function is called 50 times per seconds. It clears the screen, let all modules redraw
- *  by raising the gfx-draw event and then displays the result on the screen by flipping the
- *  double buffers.
+ *  Draws a sprite clipped to a rectangle of a surface by the kernels of the blit module.
+ *
+ *  @param target	the surface, usually the screen
+ *  @param cmd		the sprite
+ *  @param rect		the rectangle, which must lie within the surface
  *
- *  @param user_data		NULL
+ *  @returns		TRUE if a part of the sprite has been drawn, FALSE if it lies outside of the rectangle
  */
-static void _gfx_tmr_draw(void *user_data)
+static bool _gfx_raster_sprite(SDL_Surface *target, GfxCommand *cmd, SDL_Rect *rect)
 {
-	// Clear
-	SDL_FillRect(screen, NULL, SDL_MapRGB(screen->format, 0, 0, 0));
+	SDL_Surface *sheet = cmd->sheet;
+	Uint32 *src, *dst;
+	Uint32 mask, key;
+	int x1, y1, x2, y2;
 
-	// Raise draw event
-	event_raise("gfx-draw", screen);
+	// Intersect the sprite with the rectangle
+	x1 = (cmd->dest.x > rect->x) ? cmd->dest.x : rect->x;
+	y1 = (cmd->dest.y > rect->y) ? cmd->dest.y : rect->y;
+	x2 = (cmd->dest.x + cmd->dest.w < rect->x + rect->w) ? cmd->dest.x + cmd->dest.w : rect->x + rect->w;
+	y2 = (cmd->dest.y + cmd->dest.h < rect->y + rect->h) ? cmd->dest.y + cmd->dest.h : rect->y + rect->h;
+	if (x1 >= x2 || y1 >= y2)
+		return FALSE;
 
-	// Show
-	SDL_Flip(screen);
+	src = (Uint32 *)((Uint8 *)sheet->pixels + (cmd->clip.y + y1 - cmd->dest.y) * sheet->pitch) + cmd->clip.x + x1 - cmd->dest.x;
+	dst = (Uint32 *)((Uint8 *)target->pixels + y1 * target->pitch) + x1;
+	mask = ~sheet->format->Amask;
+	key = sheet->format->colorkey & mask;
+
+	// An opaque alpha value is a plain copy
+	if ((sheet->flags & SDL_SRCALPHA) && sheet->format->alpha != SDL_ALPHA_OPAQUE) {
+		if (sheet->flags & SDL_SRCCOLORKEY)
+			blit_blend_colorkey(dst, target->pitch, src, sheet->pitch, x2 - x1, y2 - y1, key, mask, sheet->format->alpha);
+		else
+			blit_blend(dst, target->pitch, src, sheet->pitch, x2 - x1, y2 - y1, sheet->format->alpha);
+	}
+	else if (sheet->flags & SDL_SRCCOLORKEY) {
+		blit_colorkey(dst, target->pitch, src, sheet->pitch, x2 - x1, y2 - y1, key, mask);
+	}
+	else {
+		blit_copy(dst, target->pitch, src, sheet->pitch, x2 - x1, y2 - y1);
+	}
+
+	return TRUE;
+}
+
+/**
+ *  Rasterizes the band of every redrawn region which belongs to a thread.
+ *
+ *  @param worker	the thread
+ */
+static void _gfx_raster_bands(GfxWorker *worker)
+{
+	SDL_Rect band;
+	int i, j, y1, y2;
+
+	for (i = 0; i < n_regions; i++) {
+		// Split the region into bands of nearly the same height
+		y1 = a_regions[i].y + a_regions[i].h * worker->band / n_bands;
+		y2 = a_regions[i].y + a_regions[i].h * (worker->band + 1) / n_bands;
+		if (y1 == y2)
+			continue;
+
+		band.x = a_regions[i].x;
+		band.y = y1;
+		band.w = a_regions[i].w;
+		band.h = y2 - y1;
+
+		_gfx_raster_fill(&band);
+		for (j = 0; j < n_commands; j++) {
+			if (_gfx_raster_sprite(screen, &a_commands[j], &band))
+				worker->blits++;
+		}
+	}
+}
+
+/**
+ *  Thread function of a worker thread. It rasterizes its bands of every frame.
+ *
+ *  @param data		the worker
+ */
+static int _gfx_worker_run(void *data)
+{
+	GfxWorker *worker = (GfxWorker *)data;
+
+	while (1) {
+		SDL_SemWait(worker->start);
+		if (workers_quit)
+			break;
+
+		_gfx_raster_bands(worker);
+		SDL_SemPost(sem_done);
+	}
+
+	return 0;
+}
+
+/**
+ *  Rasterizes the render queue into the redrawn regions. The worker threads are only
+ *  woken up if there are enough pixels to draw.
+ *
+ *  @param regions	the regions of the screen
+ *  @param count	number of regions
+ *  @param pixels	number of pixels of all regions
+ */
+static void _gfx_raster_frame(SDL_Rect *regions, int count, int pixels)
+{
+	int i;
+
+	if (SDL_MUSTLOCK(screen) && SDL_LockSurface(screen) < 0)
+		return;
+
+	a_regions = regions;
+	n_regions = count;
+	n_bands = (pixels >= GFX_MIN_THREADED_PIXELS) ? n_threads : 1;
+
+	// The semaphores make the render queue visible to the worker threads
+	for (i = 1; i < n_bands; i++) {
+		SDL_SemPost(a_workers[i].start);
+	}
+	_gfx_raster_bands(&a_workers[0]);
+	for (i = 1; i < n_bands; i++) {
+		SDL_SemWait(sem_done);
+	}
+
+	if (n_bands > 1)
+		n_threaded_frames++;
+
+	if (SDL_MUSTLOCK(screen))
+		SDL_UnlockSurface(screen);
+}
+
+/**
+ *  Clears a region of the screen and draws all sprites of the render queue which overlap it by SDL.
+ *  This is used if the rasterizer can't draw all sprites.
+ *
+ *  @param region	the region of the screen or NULL for the whole screen
+ */
+static void _gfx_draw_region(SDL_Rect *region)
+{
+	SDL_Rect clip, dest;
+	GfxCommand *cmd;
+	int i;
+
+	SDL_SetClipRect(screen, region);
+	SDL_FillRect(screen, region, SDL_MapRGB(screen->format, 0, 0, 0));
+
+	for (i = 0; i < n_commands; i++) {
+		cmd = &a_commands[i];
+
+		// Skip sprites outside of the region
+		if (region && !(cmd->dest.x < region->x + region->w && region->x < cmd->dest.x + cmd->dest.w &&
+						cmd->dest.y < region->y + region->h && region->y < cmd->dest.y + cmd->dest.h))
+			continue;
+
+		// SDL modifies the rectangles passed to it
+		clip = cmd->clip;
+		dest = cmd->dest;
+		SDL_BlitSurface(cmd->sheet, &clip, screen, &dest);
+		a_workers[0].blits++;
+	}
+
+	SDL_SetClipRect(screen, NULL);
+}
+
+/**
+ *  Event handler for the render event.
+ *  This function is called by the main loop for every frame. It fills the render queue
+ *  by raising the gfx-draw event, sorts it and redraws the invalidated regions of the
+ *  screen from it. Then only these regions are updated on the display.
+ */
+static void _gfx_evt_render(void *event_data, void *user_data)
+{
+	SDL_Rect rect;
+	int i, pixels;
+
+	// Nothing has changed
+	if (!full_redraw && dirty_rects && !n_dirty) {
+		n_frames++;
+		return;
+	}
+
+	// Let all modules submit their sprites
+	n_commands = 0;
+	rasterizable = TRUE;
+	event_raise_id(ev_gfx_draw, NULL);
+	qsort(a_commands, n_commands, sizeof(GfxCommand), _gfx_command_compare);
+	n_submitted += n_commands;
+
+	if (full_redraw || !dirty_rects) {
+		rect.x = rect.y = 0;
+		rect.w = GFX_SCREEN_WIDTH;
+		rect.h = GFX_SCREEN_HEIGHT;
+		pixels = GFX_SCREEN_WIDTH * GFX_SCREEN_HEIGHT;
+
+		if (rasterizable) {
+			_gfx_raster_frame(&rect, 1, pixels);
+		}
+		else {
+			_gfx_draw_region(NULL);
+			n_sdl_frames++;
+		}
+
+		// Show
+		SDL_Flip(screen);
+
+		n_full_frames++;
+		n_rects++;
+		n_pixels += pixels;
+	}
+	else {
+		pixels = 0;
+		for (i = 0; i < n_dirty; i++) {
+			pixels += a_dirty[i].w * a_dirty[i].h;
+		}
+
+		if (rasterizable) {
+			_gfx_raster_frame(a_dirty, n_dirty, pixels);
+		}
+		else {
+			for (i = 0; i < n_dirty; i++) {
+				// SDL modifies the rectangles passed to it
+				rect = a_dirty[i];
+				_gfx_draw_region(&rect);
+			}
+			n_sdl_frames++;
+		}
+
+		SDL_UpdateRects(screen, n_dirty, a_dirty);
+		n_rects += n_dirty;
+		n_pixels += pixels;
+	}
+
+	n_frames++;
+	n_dirty = 0;
+	full_redraw = FALSE;
+}
+
+/**
+ *  Event handler for the scene-changed event.
+ *  Another scene draws something completely different, so the whole screen is redrawn.
+ */
+static void _gfx_evt_scene_changed(void *event_data, void *user_data)
+{
+	gfx_invalidate(NULL);
 }
 
 /**
@@ -59,13 +477,57 @@ static void _gfx_tmr_draw(void *user_data)
  */
 void gfx_init()
 {
-	// Create a window
-	screen = SDL_SetVideoMode(GFX_SCREEN_WIDTH, GFX_SCREEN_HEIGHT, 32, SDL_HWSURFACE | SDL_DOUBLEBUF);
+	char *option;
+	int i;
+
+	// Register events
+	ev_gfx_draw = event_register("gfx-draw");
+
+	// Choose the pixel kernels
+	blit_init();
+
+	// Without a window nothing is drawn at all
+	if (application_is_headless()) {
+		screen = NULL;
+		evt_render = evt_scene_changed = 0;
+		return;
+	}
+
+	// Create a window. Updating single regions requires a single buffered surface.
+	dirty_rects = !application_get_option("full-redraw");
+	if (dirty_rects)
+		screen = SDL_SetVideoMode(GFX_SCREEN_WIDTH, GFX_SCREEN_HEIGHT, 32, SDL_SWSURFACE);
+	else
+		screen = SDL_SetVideoMode(GFX_SCREEN_WIDTH, GFX_SCREEN_HEIGHT, 32, SDL_HWSURFACE | SDL_DOUBLEBUF);
 	assert_ptr(screen, "couldn't set video mode", SDL_GetError);
 	SDL_WM_SetCaption("Arena 1", "Arena 1");
 
-	// Initialize a timer for drawing (50 FPS)
-	tmr_draw = timer_create_interval(20, _gfx_tmr_draw, NULL, TIMER_ENABLED);
+	n_dirty = 0;
+	full_redraw = TRUE;
+
+	// Start the rasterizing threads, by default one for each processor
+	option = application_get_option("render-threads");
+	n_threads = option ? atoi(option) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+	if (n_threads < 1)
+		n_threads = 1;
+	if (n_threads > GFX_MAX_THREADS)
+		n_threads = GFX_MAX_THREADS;
+
+	memset(a_workers, 0, sizeof(a_workers));
+	workers_quit = FALSE;
+	sem_done = SDL_CreateSemaphore(0);
+	assert_ptr(sem_done, "couldn't create semaphore", SDL_GetError);
+	for (i = 1; i < n_threads; i++) {
+		a_workers[i].band = i;
+		a_workers[i].start = SDL_CreateSemaphore(0);
+		assert_ptr(a_workers[i].start, "couldn't create semaphore", SDL_GetError);
+		a_workers[i].thread = SDL_CreateThread(_gfx_worker_run, &a_workers[i]);
+		assert_ptr(a_workers[i].thread, "couldn't create thread", SDL_GetError);
+	}
+
+	// Draw every frame rendered by the main loop
+	evt_render = event_connect("render", 0, _gfx_evt_render, NULL, EVENT_HANDLER_ENABLED);
+	evt_scene_changed = event_connect("scene-changed", 0, _gfx_evt_scene_changed, NULL, EVENT_HANDLER_ENABLED);
 }
 
 /**
@@ -73,16 +535,186 @@ void gfx_init()
  */
 void gfx_destroy()
 {
-	// Free resources
-	timer_free(tmr_draw);
+	int i;
+
+	// Unregister events
+	event_disconnect(evt_render);
+	event_disconnect(evt_scene_changed);
+
+	blit_destroy();
+
+	// Stop the rasterizing threads
+	if (!screen)
+		return;
+
+	workers_quit = TRUE;
+	for (i = 1; i < n_threads; i++) {
+		SDL_SemPost(a_workers[i].start);
+		SDL_WaitThread(a_workers[i].thread, NULL);
+		SDL_DestroySemaphore(a_workers[i].start);
+	}
+	SDL_DestroySemaphore(sem_done);
+}
+
+/**
+ *  Invalidates a region of the screen, so it is redrawn in the next frame. Objects
+ *  must invalidate the region they have been drawn to as well as the new one whenever
+ *  they change their appearance or position.
+ *
+ *  Overlapping regions are merged. If there are too many regions, the whole screen is redrawn.
+ *
+ *  @param rect		the region in screen coordinates or NULL to redraw the whole screen
+ */
+void gfx_invalidate(SDL_Rect *rect)
+{
+	SDL_Rect r;
+	int i;
+
+	if (!screen || full_redraw)
+		return;
+
+	if (!rect) {
+		full_redraw = TRUE;
+		return;
+	}
+
+	// Clip the region to the screen
+	r = *rect;
+	if (r.x < 0) {
+		r.w = (r.w > -r.x) ? r.w + r.x : 0;
+		r.x = 0;
+	}
+	if (r.y < 0) {
+		r.h = (r.h > -r.y) ? r.h + r.y : 0;
+		r.y = 0;
+	}
+	if (r.x + r.w > GFX_SCREEN_WIDTH)
+		r.w = (r.x < GFX_SCREEN_WIDTH) ? GFX_SCREEN_WIDTH - r.x : 0;
+	if (r.y + r.h > GFX_SCREEN_HEIGHT)
+		r.h = (r.y < GFX_SCREEN_HEIGHT) ? GFX_SCREEN_HEIGHT - r.y : 0;
+	if (!r.w || !r.h)
+		return;
+
+	// Merge it with all regions it touches. The merged region may touch further regions.
+	i = 0;
+	while (i < n_dirty) {
+		if (_gfx_rects_touch(&a_dirty[i], &r)) {
+			_gfx_rects_union(&r, &a_dirty[i]);
+			a_dirty[i] = a_dirty[--n_dirty];
+			i = 0;
+		}
+		else {
+			i++;
+		}
+	}
+
+	if (n_dirty == GFX_MAX_DIRTY_RECTS) {
+		full_redraw = TRUE;
+		return;
+	}
+
+	a_dirty[n_dirty++] = r;
+}
+
+/**
+ *  Submits a sprite to the render queue of the current frame.
+ *
+ *  @attention	Call this function during a gfx-draw event only!
+ *
+ *  @param sheet	the sprite sheet
+ *  @param clip		the part of the sprite sheet to draw or NULL for the whole sheet
+ *  @param x		x coordinate of the upper left corner on the screen
+ *  @param y		y coordinate of the upper left corner on the screen
+ *  @param layer	the layer to which the sprite belongs
+ */
+void gfx_submit(SDL_Surface *sheet, SDL_Rect *clip, int x, int y, GfxLayer layer)
+{
+	GfxCommand *cmd;
+
+	if (!screen || !sheet)
+		return;
+
+	if (n_commands == GFX_MAX_COMMANDS) {
+		n_dropped++;
+		return;
+	}
+
+	cmd = &a_commands[n_commands];
+	if (!_gfx_command_init(cmd, sheet, clip, x, y))
+		return;
+
+	if (!_gfx_can_raster(sheet, screen))
+		rasterizable = FALSE;
+
+	cmd->layer = layer;
+	cmd->order = n_commands++;
+}
+
+/**
+ *  Draws a sprite onto a surface at once, using the same kernels as the rasterizer if
+ *  possible. This is meant for surfaces which are cached, like layers of the background.
+ *
+ *  @param sheet	the sprite sheet
+ *  @param clip		the part of the sprite sheet to draw or NULL for the whole sheet
+ *  @param target	the surface
+ *  @param x		x coordinate of the upper left corner on the surface
+ *  @param y		y coordinate of the upper left corner on the surface
+ */
+void gfx_blit(SDL_Surface *sheet, SDL_Rect *clip, SDL_Surface *target, int x, int y)
+{
+	GfxCommand cmd;
+	SDL_Rect rect, dest;
+
+	if (!sheet || !target || !_gfx_command_init(&cmd, sheet, clip, x, y))
+		return;
+
+	if (!_gfx_can_raster(sheet, target) || (SDL_MUSTLOCK(target) && SDL_LockSurface(target) < 0)) {
+		dest = cmd.dest;
+		SDL_BlitSurface(sheet, &cmd.clip, target, &dest);
+		return;
+	}
+
+	SDL_GetClipRect(target, &rect);
+	_gfx_raster_sprite(target, &cmd, &rect);
+
+	if (SDL_MUSTLOCK(target))
+		SDL_UnlockSurface(target);
+}
+
+/**
+ *  Prints statistics about the redrawn regions and the render queue.
+ */
+void gfx_print_stats()
+{
+	Uint64 blits = 0;
+	int i;
+
+	for (i = 0; i < n_threads; i++) {
+		blits += a_workers[i].blits;
+	}
+
+	printf("gfx frames: %llu  full redraws: %llu  regions per frame: %.1f  pixels per frame: %.0f (%.1f%% of the screen)\n",
+			(unsigned long long)n_frames,
+			(unsigned long long)n_full_frames,
+			n_frames ? (double)n_rects / n_frames : 0.0,
+			n_frames ? (double)n_pixels / n_frames : 0.0,
+			n_frames ? 100.0 * n_pixels / n_frames / (GFX_SCREEN_WIDTH * GFX_SCREEN_HEIGHT) : 0.0);
+	printf("gfx sprites per frame: %.1f  clipped blits per frame: %.1f  dropped: %llu\n",
+			n_frames ? (double)n_submitted / n_frames : 0.0,
+			n_frames ? (double)blits / n_frames : 0.0,
+			(unsigned long long)n_dropped);
+	printf("gfx threads: %d  threaded frames: %llu  frames drawn by SDL: %llu\n",
+			n_threads,
+			(unsigned long long)n_threaded_frames,
+			(unsigned long long)n_sdl_frames);
 }
 
 /**
  *  Gets the SDL surface which is presented to the user.
  *
- *  @attention	Draw to this surface during a gfx-draw event only!
+ *  @attention	Other modules should submit sprites by gfx_submit() instead of drawing to this surface!
  *
- *  @returns 	the SDL surface
+ *  @returns 	the SDL surface or NULL if the application runs headless
  */
 SDL_Surface * gfx_get_screen()
 {
@@ -24,11 +24,27 @@
  *  @brief Responsible for SDL library initialization
  *
  *  This module initializes the SDL library.
- *  After initialization it begins to raise the gfx-draw event
- *  50 times per second. Before raising the event the entire screen
- *  is cleared. Other modules should draw their objects
- *  onto the surface provided by the event_data of this event, so
- *  they are correctly displayed after the event has been processed.
+ *  After initialization it raises the gfx-draw event for every frame
+ *  rendered by the main loop (see the loop module). Other modules don't draw onto the
+ *  screen themselves, they submit their sprites to the render queue by gfx_submit()
+ *  during this event.
+ *
+ *  When all sprites have been submitted, the render queue is sorted by layer, then by
+ *  the bottom edge of the sprites, so lower objects overlap upper ones, and finally by
+ *  sprite sheet. It is then drawn in one loop.
+ *
+ *  The screen is rasterized by several threads in parallel. Every region which is redrawn
+ *  is split into horizontal bands, one for each thread, and each thread draws the whole
+ *  render queue clipped to its bands. The number of threads is given by --render-threads,
+ *  by default one for each processor up to GFX_MAX_THREADS. Small updates are drawn by the
+ *  main thread alone. The pixels are drawn by the kernels of the blit module. Sprites must
+ *  have the pixel format of the screen and may only use a color key and a per-surface
+ *  alpha value, otherwise the frame is drawn by SDL on the main thread.
+ *
+ *  Only the regions of the screen which have been invalidated by gfx_invalidate() are
+ *  redrawn and updated on the display. Each region is cleared and only the sprites which
+ *  overlap it are drawn again. With the option --full-redraw the entire screen is cleared
+ *  and redrawn every frame.
  *
  *  @{
  */
@@ -38,10 +54,29 @@
 
 #define GFX_SCREEN_WIDTH		1024		/**< width of the screen surface */
 #define GFX_SCREEN_HEIGHT		768			/**< height of the screen surface */
+#define GFX_MAX_DIRTY_RECTS		64			/**< maximal number of invalidated regions, if there are more the whole screen is redrawn */
+#define GFX_MAX_COMMANDS		1024		/**< maximal number of sprites in the render queue per frame, further sprites are dropped */
+#define GFX_MAX_THREADS			8			/**< maximal number of threads which rasterize a frame, including the main thread */
+#define GFX_MIN_THREADED_PIXELS	65536		/**< minimal number of redrawn pixels for which the worker threads are woken up */
+
+/**
+ *  The layers of the render queue. Sprites of a higher layer are drawn on top of sprites
+ *  of a lower one.
+ */
+typedef enum {
+	GFX_LAYER_BACKGROUND	= 0,	/**< backgrounds which cover the whole screen */
+	GFX_LAYER_GROUND		= 1,	/**< flat sprites which lie on the background */
+	GFX_LAYER_OBJECTS		= 2,	/**< objects, which are drawn from top to bottom of the screen */
+	GFX_LAYER_OVERLAY		= 3,	/**< messages which are drawn on top of everything */
+} GfxLayer;
 
 extern void gfx_init();
 extern void gfx_destroy();
 extern SDL_Surface * gfx_get_screen();
+extern void gfx_invalidate(SDL_Rect *rect);
+extern void gfx_submit(SDL_Surface *sheet, SDL_Rect *clip, int x, int y, GfxLayer layer);
+extern void gfx_blit(SDL_Surface *sheet, SDL_Rect *clip, SDL_Surface *target, int x, int y);
+extern void gfx_print_stats();
 
 #endif /* GFX_H_ */
 
@@ -24,7 +24,7 @@
  *  @brief Contains the program entry point.
  *
  *  This module contains the program entry point where it initializes all modules
- *  and starts an event loop. If an application exit is requested, it
+ *  and runs the main loop (see the loop module). If an application exit is requested, it
  *  destroys all modules so that every allocated data is freed before exiting
  *  the application.
  *
@@ -38,13 +38,14 @@
 #include "game/game.h"
 #include "menu.h"
 #include "gfx.h"
+#include "blit.h"
 
 
 
 int main (int argc, char *argv[])
 {
-	// Initialize random generator
-	srand(time(NULL));
+	char *seed;
+	int status = 0;
 
 	// Initialize all modules
 #ifdef DEBUG
@@ -64,56 +65,39 @@ int main (int argc, char *argv[])
 	menu_init();
 #endif
 
-	// Set initial scene
-	scene_push("menu");
+	// Initialize random generator, with the seed given by --seed to repeat a simulation
+	seed = application_get_option("seed");
+	srand(seed ? (unsigned int)atoi(seed) : time(NULL));
 
-	// Begin main loop
-	bool app_run = TRUE;
-	while (app_run) {
-		SDL_Event event;
-
-		// Process events
-		if (!SDL_WaitEvent(&event)) {
-			// Exit if there was an error
-			app_run = 0;
-			continue;
-		}
-
-		switch (event.type) {
-			case SDL_QUIT:
-				app_run = FALSE;
-				break;
-
-			case SDL_KEYDOWN:
-				event_raise("sdl-key-down", &event.key);
-				break;
-
-			case SDL_KEYUP:
-				event_raise("sdl-key-up", &event.key);
-				break;
-
-			case SDL_MOUSEBUTTONDOWN:
-				event_raise("sdl-mouse-down", &event.button);
-				break;
-
-			case SDL_MOUSEBUTTONUP:
-				event_raise("sdl-mouse-up", &event.button);
-				break;
-
-			case SDL_MOUSEMOTION:
-				event_raise("sdl-mouse-motion", &event.motion);
-				break;
+	if (application_get_option("bench-blit")) {
+		// Only compare the blit kernels with SDL, best together with --headless
+		blit_benchmark();
+	}
+	else if (application_get_option("check-mpsc")) {
+		// Only check the lock-free queue with several threads, best together with --headless
+		if (!mpsc_self_check())
+			status = 1;
+	}
+	else {
+		// Set initial scene. Without a window there is no menu, the game starts at once.
+		scene_push(application_is_headless() ? "game" : "menu");
 
-			case SDL_USEREVENT:
-				event_raise("sdl-user", &event);
-				break;
-		}
+		// Run the main loop until the application quits
+		loop_run();
 	}
 
 #ifdef DEBUG_EVENTS
 	event_print_structure();
 #endif
 
+	// Print the statistics collected while running if --stats is given
+	if (application_get_option("stats")) {
+		event_print_stats();
+		timer_print_stats();
+		loop_print_stats();
+		gfx_print_stats();
+	}
+
 	// Destroy all modules
 #ifdef DEBUG
 	printf("destroying modules...\n");
@@ -140,7 +124,7 @@ int main (int argc, char *argv[])
 	printf("list free coutn:  %6d\n", list_free_count);
 #endif
 
-	return 0;
+	return status;
 }
 
 /** @} */
@@ -26,20 +26,18 @@
 
 #include <SDL/SDL.h>
 #include "core/core.h"
+#include "gfx.h"
 
 
 
 static int 			 evt_gfx_draw;									/**< id of the gfx-draw event handler */
 static int 			 evt_sdl_key_down;								/**< id of the sdl-key-down event handler */
-static int 			 evt_scene_changed;								/**< id of the scene-changed event handler */
 
 static SDL_Surface	*s_menu;
 
 static void _menu_evt_gfx_draw(void *event_data, void *user_data)
 {
-	SDL_Surface *screen = (SDL_Surface *)event_data;
-
-	SDL_BlitSurface(s_menu, NULL, screen, NULL);
+	gfx_submit(s_menu, NULL, 0, 0, GFX_LAYER_BACKGROUND);
 }
 
 static void _menu_evt_sdl_key_down(void *event_data, void *user_data)
@@ -60,24 +58,17 @@ static void _menu_evt_sdl_key_down(void *event_data, void *user_data)
 	}
 }
 
-static void _menu_evt_scene_changed(void *event_data, void *user_data)
-{
-	if (scene_check("menu")) {
-		event_handler_set_state(evt_gfx_draw, EVENT_HANDLER_ENABLED);
-		event_handler_set_state(evt_sdl_key_down, EVENT_HANDLER_ENABLED);
-	}
-	else {
-		event_handler_set_state(evt_gfx_draw, EVENT_HANDLER_DISABLED);
-		event_handler_set_state(evt_sdl_key_down, EVENT_HANDLER_DISABLED);
-	}
-}
-
 
 void menu_init()
 {
-	evt_gfx_draw = event_connect("gfx-draw", 0, _menu_evt_gfx_draw, NULL, EVENT_HANDLER_DISABLED);
-	evt_sdl_key_down = event_connect("sdl-key-down", 0, _menu_evt_sdl_key_down, NULL, EVENT_HANDLER_DISABLED);
-	evt_scene_changed = event_connect("scene-changed", 0, _menu_evt_scene_changed, NULL, EVENT_HANDLER_ENABLED);
+	// The event handlers are only active in the menu scene
+	int grp_menu = group_register("menu");
+	group_bind_scene(grp_menu, scene_register("menu"));
+
+	evt_gfx_draw = event_connect("gfx-draw", 0, _menu_evt_gfx_draw, NULL, EVENT_HANDLER_ENABLED);
+	evt_sdl_key_down = event_connect("sdl-key-down", 0, _menu_evt_sdl_key_down, NULL, EVENT_HANDLER_ENABLED);
+	event_handler_set_group(evt_gfx_draw, grp_menu);
+	event_handler_set_group(evt_sdl_key_down, grp_menu);
 
 	s_menu = assert_sprite("sprites/menu.png");
 }
@@ -86,7 +77,6 @@ void menu_destroy()
 {
 	event_disconnect(evt_gfx_draw);
 	event_disconnect(evt_sdl_key_down);
-	event_disconnect(evt_scene_changed);
 
 	SDL_FreeSurface(s_menu);
 }